@@ -0,0 +1,423 @@
+#include "book_engine.hpp"
+#include "latency_histogram.hpp"
+#include "order_book_manager_impl.hpp"
+#include "perf_counters.hpp"
+#include "workload_generator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#define NUM_HANDLERS 5
+
+// matching flow: share of adds priced through the touch, how far through, and of cancels
+#define MATCH_AGGRESSIVE_PERCENT 35
+#define MATCH_MAX_CROSS_TICKS 4
+#define MATCH_CANCEL_PERCENT 20
+#define MATCH_MAX_LIVE_ORDERS (1 << 20)
+
+static const char *handler_names[NUM_HANDLERS] = {"OnOrderAdd", "OnOrderDelete", "OnOrderModify", "OnOrderReplace",
+                                                  "OnOrderExec"};
+
+static int GetHandlerIndex(uint8_t t_event_type_)
+{
+    switch (t_event_type_)
+    {
+    case ORDER_EVENT_ADD:
+        return 0;
+    case ORDER_EVENT_DELETE:
+        return 1;
+    case ORDER_EVENT_MODIFY:
+        return 2;
+    case ORDER_EVENT_REPLACE:
+        return 3;
+    case ORDER_EVENT_EXEC:
+        return 4;
+    default:
+        return -1;
+    }
+}
+
+static bool DumpEvents(const std::string &t_file_name_, const std::vector<OrderEvent> &t_events_)
+{
+    FILE *file = fopen(t_file_name_.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    size_t written = fwrite(t_events_.data(), sizeof(OrderEvent), t_events_.size(), file);
+    fclose(file);
+    return written == t_events_.size();
+}
+
+/*
+ * Runs the workload twice on fresh books: once untimed per event to get the sustained
+ * throughput, and once with every handler call timed to fill the latency histograms.
+ * With @t_batch_size_ > 0 the throughput run feeds ProcessBatch that many events at a time.
+ * With @t_perf_mode_ a third run on a fresh book reads the hardware counters around every run of
+ * events of one type and prints their cost per event (perf_counters.hpp).
+ */
+static void RunScenario(const WorkloadConfig &t_config_, const std::string &t_dump_file_, bool t_l3_mode_,
+                        size_t t_batch_size_, bool t_perf_mode_)
+{
+    std::vector<OrderEvent> events;
+    WorkloadGenerator generator(t_config_);
+    generator.Generate(events);
+
+    if (!t_dump_file_.empty())
+    {
+        if (DumpEvents(t_dump_file_, events))
+        {
+            std::cout << "Dumped " << events.size() << " events to " << t_dump_file_ << "\n";
+        }
+        else
+        {
+            std::cerr << "Could not write " << t_dump_file_ << "\n";
+        }
+    }
+
+    double wall_time = 0.0;
+    {
+        BookArena book_arena(OrderBookManager::GetMemorySize(t_config_.max_live_orders_, t_l3_mode_));
+        ScopedBookMemoryResource book_memory(&book_arena);
+        OrderBook ob("BENCH", t_config_.min_price_increment_);
+        OrderBookManager om(ob, t_config_.max_live_orders_, t_l3_mode_);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (t_batch_size_ > 0)
+        {
+            for (size_t i = 0; i < events.size(); i += t_batch_size_)
+            {
+                om.ProcessBatch(&events[i], std::min(t_batch_size_, events.size() - i));
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                om.OnEvent(events[i]);
+            }
+        }
+        wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static LatencyHistogram histograms[NUM_HANDLERS];
+#if LATENCY_PROBES_ON
+    static BookProbes probes;
+#endif
+    for (int handler = 0; handler < NUM_HANDLERS; handler++)
+    {
+        histograms[handler].Reset();
+    }
+
+    {
+        BookArena book_arena(OrderBookManager::GetMemorySize(t_config_.max_live_orders_, t_l3_mode_));
+        ScopedBookMemoryResource book_memory(&book_arena);
+        OrderBook ob("BENCH", t_config_.min_price_increment_);
+        OrderBookManager om(ob, t_config_.max_live_orders_, t_l3_mode_);
+
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            om.OnEvent(events[i]);
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+            int handler = GetHandlerIndex(events[i].type);
+            if (handler >= 0)
+            {
+                histograms[handler].Record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            }
+        }
+#if LATENCY_PROBES_ON
+        probes = ob.GetProbes();
+#endif
+    }
+
+    printf("Scenario %-10s events %zu  batch %zu  wall time %.3f s  %.0f events/sec\n", t_config_.name_.c_str(),
+           events.size(), t_batch_size_, wall_time, (wall_time > 0.0 ? events.size() / wall_time : 0.0));
+    printf("  %-15s %10s %8s %8s %8s %8s %10s\n", "handler (ns)", "count", "mean", "p50", "p99", "p99.9", "max");
+    for (int handler = 0; handler < NUM_HANDLERS; handler++)
+    {
+        const LatencyHistogram &histogram = histograms[handler];
+        if (histogram.GetCount() == 0)
+        {
+            continue;
+        }
+        printf("  %-15s %10llu %8.0f %8llu %8llu %8llu %10llu\n", handler_names[handler],
+               (unsigned long long)histogram.GetCount(), histogram.GetMean(),
+               (unsigned long long)histogram.GetPercentile(50.0), (unsigned long long)histogram.GetPercentile(99.0),
+               (unsigned long long)histogram.GetPercentile(99.9), (unsigned long long)histogram.GetMax());
+    }
+#if LATENCY_PROBES_ON
+    fflush(stdout);
+    DumpBookProbes(probes, std::cout);
+    std::cout.flush();
+#endif
+
+    if (t_perf_mode_)
+    {
+        BookArena book_arena(OrderBookManager::GetMemorySize(t_config_.max_live_orders_, t_l3_mode_));
+        ScopedBookMemoryResource book_memory(&book_arena);
+        OrderBook ob("BENCH", t_config_.min_price_increment_);
+        OrderBookManager om(ob, t_config_.max_live_orders_, t_l3_mode_);
+
+        fflush(stdout);
+        PerfEventProfile perf_profile;
+        if (perf_profile.Open())
+        {
+            ProfileEvents(perf_profile, om, events.data(), events.size());
+            perf_profile.Print(std::cout);
+        }
+        std::cout.flush();
+    }
+    printf("\n");
+}
+
+// counts the trades of matching mode, so the fill callback isn't compiled away
+struct FillCounter
+{
+    uint64_t num_fills_;
+    uint64_t filled_size_;
+
+    FillCounter() : num_fills_(0), filled_size_(0) {}
+
+    void OnLevelUpdate(const LevelUpdate &) {}
+    void OnFill(const Fill &t_fill_)
+    {
+        num_fills_++;
+        filled_size_ += t_fill_.size;
+    }
+};
+
+/*
+ * Matching mode throughput: limit orders around a slowly moving mid, some priced through
+ * the other side, plus cancels of earlier orders, some of them already filled. The stream is
+ * only adds and deletes, as the manager itself is the venue here.
+ */
+static void RunMatchingScenario(unsigned int t_num_events_, uint64_t t_seed_)
+{
+    const double min_price_increment = 0.01;
+    std::mt19937_64 generator(t_seed_);
+    std::vector<OrderEvent> events(t_num_events_);
+    std::vector<std::pair<uint64_t, uint8_t> > added_orders;
+    added_orders.reserve(t_num_events_);
+
+    int mid_int_price = 100000;
+    uint64_t next_order_id = 1;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        OrderEvent &event = events[i];
+        memset(&event, 0, sizeof(event));
+        if (i % 64 == 0)
+        {
+            mid_int_price += (int)(generator() % 3) - 1;
+        }
+
+        if (!added_orders.empty() && generator() % 100 < MATCH_CANCEL_PERCENT)
+        {
+            const std::pair<uint64_t, uint8_t> &order = added_orders[generator() % added_orders.size()];
+            event.type = ORDER_EVENT_DELETE;
+            event.order_id = order.first;
+            event.side = order.second;
+            continue;
+        }
+
+        event.type = ORDER_EVENT_ADD;
+        event.side = (generator() % 2 == 0 ? 'B' : 'S');
+        event.order_id = next_order_id++;
+        event.size = 1 + generator() % 100;
+        // ticks away from the mid on the passive side, negative is through it
+        const int distance = (generator() % 100 < MATCH_AGGRESSIVE_PERCENT
+                                  ? -(int)(generator() % (MATCH_MAX_CROSS_TICKS + 1))
+                                  : 1 + (int)(generator() % 20));
+        const int int_price = (event.side == 'B' ? mid_int_price - distance : mid_int_price + distance);
+        event.price = int_price * min_price_increment;
+        added_orders.push_back(std::make_pair(event.order_id, event.side));
+    }
+
+    BookArena book_arena(BasicOrderBookManager<FillCounter>::GetMemorySize(MATCH_MAX_LIVE_ORDERS, true));
+    ScopedBookMemoryResource book_memory(&book_arena);
+    OrderBook ob("MATCH", min_price_increment);
+    BasicOrderBookManager<FillCounter> om(ob, MATCH_MAX_LIVE_ORDERS, true);
+    om.SetMatchingMode(true);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        om.OnEvent(events[i]);
+    }
+    double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const FillCounter &fills = om.GetLevelListener();
+    if (om.GetAnomalyCount(BOOK_ANOMALY_ORDER_MAP_FULL) != 0)
+    {
+        std::cerr << "Order map full, more than " << MATCH_MAX_LIVE_ORDERS << " live orders per side\n";
+    }
+    printf("Scenario %-10s events %zu  fills %llu  filled size %llu  wall time %.3f s  %.0f events/sec\n\n",
+           "matching", events.size(), (unsigned long long)fills.num_fills_, (unsigned long long)fills.filled_size_,
+           wall_time, (wall_time > 0.0 ? events.size() / wall_time : 0.0));
+}
+
+/*
+ * Spreads the workload over @t_num_symbols_ books, each with its own seeded stream, and
+ * pushes the streams interleaved through a BookEngine with @t_num_workers_ workers.
+ * Reports the end to end throughput, from the first Submit until all workers are done.
+ */
+static void RunEngineScenario(const WorkloadConfig &t_config_, int t_num_symbols_, int t_num_workers_,
+                              int t_first_cpu_, bool t_l3_mode_)
+{
+    std::vector<std::vector<OrderEvent> > symbol_events(t_num_symbols_);
+    for (int symbol = 0; symbol < t_num_symbols_; symbol++)
+    {
+        WorkloadConfig config = t_config_;
+        config.seed_ = t_config_.seed_ + symbol;
+        config.num_events_ = t_config_.num_events_ / t_num_symbols_;
+        WorkloadGenerator generator(config);
+        generator.Generate(symbol_events[symbol]);
+    }
+
+    BookEngine engine(t_num_workers_, t_first_cpu_);
+    for (int symbol = 0; symbol < t_num_symbols_; symbol++)
+    {
+        engine.AddSymbol("SYM" + std::to_string(symbol), t_config_.min_price_increment_, t_config_.max_live_orders_,
+                         t_l3_mode_);
+    }
+
+    size_t num_events = 0;
+    engine.Start();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < symbol_events[0].size(); i++)
+    {
+        for (int symbol = 0; symbol < t_num_symbols_; symbol++)
+        {
+            if (i < symbol_events[symbol].size())
+            {
+                engine.Submit(symbol, symbol_events[symbol][i]);
+                num_events++;
+            }
+        }
+    }
+    engine.Stop();
+    double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Scenario %-10s symbols %d  workers %d  events %zu  wall time %.3f s  %.0f events/sec\n",
+           t_config_.name_.c_str(), t_num_symbols_, t_num_workers_, num_events, wall_time,
+           (wall_time > 0.0 ? num_events / wall_time : 0.0));
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> scenarios;
+    unsigned int num_events = 1000000;
+    uint64_t seed = 1;
+    std::string dump_file;
+    bool l3_mode = false;
+    int num_symbols = 0;
+    int num_workers = 1;
+    int first_cpu = -1;
+    size_t batch_size = 0;
+    bool matching_mode = false;
+    bool perf_mode = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--events") == 0 && i + 1 < argc)
+        {
+            num_events = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc)
+        {
+            scenarios.push_back(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc)
+        {
+            dump_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--l3") == 0)
+        {
+            l3_mode = true;
+        }
+        else if (strcmp(argv[i], "--symbols") == 0 && i + 1 < argc)
+        {
+            num_symbols = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+        {
+            num_workers = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc)
+        {
+            first_cpu = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+        {
+            batch_size = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--match") == 0)
+        {
+            matching_mode = true;
+        }
+        else if (strcmp(argv[i], "--perf") == 0)
+        {
+            perf_mode = true;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--scenario name]... [--events N] [--seed S] [--dump file] [--l3] [--batch N]"
+                      << " [--symbols N [--workers W] [--cpu first_cpu]] [--match] [--perf]\n";
+            std::cerr << "Scenarios:";
+            std::vector<std::string> names = GetWorkloadPresetNames();
+            for (size_t j = 0; j < names.size(); j++)
+            {
+                std::cerr << " " << names[j];
+            }
+            std::cerr << "\n";
+            return 1;
+        }
+    }
+
+    if (matching_mode)
+    {
+        RunMatchingScenario(num_events, seed);
+        return 0;
+    }
+
+    if (scenarios.empty())
+    {
+        scenarios = GetWorkloadPresetNames();
+    }
+    if (!dump_file.empty() && scenarios.size() != 1)
+    {
+        std::cerr << "--dump needs exactly one --scenario\n";
+        return 1;
+    }
+
+    for (size_t i = 0; i < scenarios.size(); i++)
+    {
+        WorkloadConfig config;
+        if (!GetWorkloadPreset(scenarios[i], config))
+        {
+            std::cerr << "Unknown scenario " << scenarios[i] << "\n";
+            return 1;
+        }
+        config.num_events_ = num_events;
+        config.seed_ = seed;
+        if (num_symbols > 0)
+        {
+            RunEngineScenario(config, num_symbols, num_workers, first_cpu, l3_mode);
+        }
+        else
+        {
+            RunScenario(config, dump_file, l3_mode, batch_size, perf_mode);
+        }
+    }
+    return 0;
+}
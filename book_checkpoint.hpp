@@ -0,0 +1,123 @@
+#ifndef BOOK_CHECKPOINT_HPP
+#define BOOK_CHECKPOINT_HPP
+
+#include <cstdint>
+
+#define BOOK_CHECKPOINT_MAGIC 0x54504b434b4f4f42ull // "BOOKCKPT"
+#define BOOK_CHECKPOINT_VERSION 2
+#define BOOK_CHECKPOINT_SYMBOL_LENGTH 32
+
+/*
+ * Layout of a book checkpoint file, written by OrderBookManager::SaveCheckpoint and
+ * memory mapped by LoadCheckpoint. All in native byte order:
+ *
+ *  BookCheckpointHeader
+ *  int32 bid sizes[max_tick_range], int32 bid ordercounts[max_tick_range]
+ *  int32 ask sizes[max_tick_range], int32 ask ordercounts[max_tick_range]
+ *  BookCheckpointOrder bid orders[num_orders of the bid side]
+ *  BookCheckpointOrder ask orders[num_orders of the ask side]
+ *  BookCheckpointLevel bid overflow levels[num_overflow_levels of the bid side]
+ *  BookCheckpointLevel ask overflow levels[num_overflow_levels of the ask side]
+ *
+ * Levels are stored by index (index 0 first), not by ring slot. A checkpoint taken in L3 mode
+ * lists the orders of every level in time priority, so the queues come back in the same order.
+ * The overflow tiers are stored as they are, worst price first, since a book fed by levels has
+ * no orders to sum them up from. They come last so the orders stay 8 byte aligned.
+ */
+struct BookCheckpointSide
+{
+    uint32_t base_index;
+    int32_t first_int_price;
+    uint64_t num_orders;
+    uint64_t num_overflow_levels;
+};
+
+struct BookCheckpointHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t l3_mode;
+    char symbol[BOOK_CHECKPOINT_SYMBOL_LENGTH];
+    double min_price_increment;
+    uint32_t max_tick_range;
+    uint32_t initial_book_constructed;
+    BookCheckpointSide sides[2]; // indexed by Side
+};
+
+struct BookCheckpointOrder
+{
+    uint64_t order_id;
+    int32_t int_price;
+    int32_t size;
+};
+
+struct BookCheckpointLevel
+{
+    int32_t int_price;
+    int32_t size;
+    int32_t ordercount;
+};
+
+// Why SaveCheckpoint/LoadCheckpoint failed, the manager never prints it itself
+enum BookCheckpointStatus
+{
+    BOOK_CHECKPOINT_OK = 0,
+    BOOK_CHECKPOINT_CANNOT_CREATE,      // file couldn't be created
+    BOOK_CHECKPOINT_WRITE_FAILED,       // short write, the partial file is removed
+    BOOK_CHECKPOINT_CANNOT_OPEN,        // file couldn't be opened
+    BOOK_CHECKPOINT_TOO_SHORT,          // smaller than a header
+    BOOK_CHECKPOINT_CANNOT_MAP,         // mmap failed
+    BOOK_CHECKPOINT_WRONG_VERSION,      // bad magic or another layout version
+    BOOK_CHECKPOINT_OTHER_BOOK,         // other symbol, tick size or window size
+    BOOK_CHECKPOINT_WRONG_SIZE,         // file size doesn't match the header
+    BOOK_CHECKPOINT_TOO_MANY_ORDERS,    // more live orders than the order maps hold
+    BOOK_CHECKPOINT_NO_QUEUES,          // taken in L2 mode, loaded into an L3 manager
+    BOOK_CHECKPOINT_ORDERS_NOT_STORED   // an order map refused an order, the book is flushed
+};
+
+inline const char *GetBookCheckpointStatusText(BookCheckpointStatus t_status_)
+{
+    switch (t_status_)
+    {
+    case BOOK_CHECKPOINT_OK:
+        return "ok";
+    case BOOK_CHECKPOINT_CANNOT_CREATE:
+        return "could not be created";
+    case BOOK_CHECKPOINT_WRITE_FAILED:
+        return "could not be written";
+    case BOOK_CHECKPOINT_CANNOT_OPEN:
+        return "could not be opened";
+    case BOOK_CHECKPOINT_TOO_SHORT:
+        return "is too short";
+    case BOOK_CHECKPOINT_CANNOT_MAP:
+        return "could not be mapped";
+    case BOOK_CHECKPOINT_WRONG_VERSION:
+        return "is not a book checkpoint of this version";
+    case BOOK_CHECKPOINT_OTHER_BOOK:
+        return "is for another symbol, tick size or window size";
+    case BOOK_CHECKPOINT_WRONG_SIZE:
+        return "has the wrong size";
+    case BOOK_CHECKPOINT_TOO_MANY_ORDERS:
+        return "has more live orders than the order maps hold";
+    case BOOK_CHECKPOINT_NO_QUEUES:
+        return "was taken without order queues (L2 mode)";
+    case BOOK_CHECKPOINT_ORDERS_NOT_STORED:
+        return "orders could not be stored, book flushed";
+    default:
+        return "unknown";
+    }
+}
+
+inline void SetCheckpointStatus(BookCheckpointStatus *t_status_, BookCheckpointStatus t_value_)
+{
+    if (t_status_ != nullptr)
+    {
+        *t_status_ = t_value_;
+    }
+}
+
+static_assert(sizeof(BookCheckpointHeader) == 112, "BookCheckpointHeader layout changed, bump the version");
+static_assert(sizeof(BookCheckpointOrder) == 16, "BookCheckpointOrder layout changed, bump the version");
+static_assert(sizeof(BookCheckpointLevel) == 12, "BookCheckpointLevel layout changed, bump the version");
+
+#endif
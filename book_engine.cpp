@@ -0,0 +1,165 @@
+#include "book_engine.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <iostream>
+
+BookEngine::BookEngine(int t_num_workers_, int t_first_cpu_, size_t t_queue_capacity_)
+    : symbol_configs_(),
+      arenas_(),
+      books_(),
+      managers_(),
+      workers_(t_num_workers_ > 0 ? t_num_workers_ : 1),
+      first_cpu_(t_first_cpu_),
+      is_running_(false),
+      num_ready_workers_(0)
+{
+    for (size_t index = 0; index < workers_.size(); index++)
+    {
+        workers_[index].queue_.reset(new SPSCQueue<EngineEvent>(t_queue_capacity_));
+        workers_[index].num_events_ = 0;
+    }
+}
+
+BookEngine::~BookEngine()
+{
+    Stop();
+}
+
+uint32_t BookEngine::AddSymbol(const std::string &t_symbol_, double t_min_price_increment_, size_t t_max_live_orders_,
+                               bool t_l3_mode_)
+{
+    if (is_running_.load())
+    {
+        std::cout << " Cannot add symbol " << t_symbol_ << " while the engine is running\n";
+        return (uint32_t)-1;
+    }
+    SymbolConfig symbol_config;
+    symbol_config.symbol_ = t_symbol_;
+    symbol_config.min_price_increment_ = t_min_price_increment_;
+    symbol_config.max_live_orders_ = t_max_live_orders_;
+    symbol_config.l3_mode_ = t_l3_mode_;
+    symbol_configs_.push_back(symbol_config);
+
+    // slots only, every worker fills in its own
+    arenas_.push_back(std::unique_ptr<BookArena>());
+    books_.push_back(std::unique_ptr<OrderBook>());
+    managers_.push_back(std::unique_ptr<OrderBookManager>());
+    return books_.size() - 1;
+}
+
+void BookEngine::Start()
+{
+    if (is_running_.exchange(true))
+    {
+        return;
+    }
+    num_ready_workers_.store(0);
+    for (size_t index = 0; index < workers_.size(); index++)
+    {
+        workers_[index].thread_ = std::thread(&BookEngine::RunWorker, this, (int)index);
+    }
+    while (num_ready_workers_.load(std::memory_order_acquire) < (int)workers_.size())
+    {
+        std::this_thread::yield();
+    }
+}
+
+void BookEngine::Stop()
+{
+    if (!is_running_.exchange(false, std::memory_order_release))
+    {
+        return;
+    }
+    for (size_t index = 0; index < workers_.size(); index++)
+    {
+        workers_[index].thread_.join();
+    }
+}
+
+bool BookEngine::Submit(uint32_t t_symbol_id_, const OrderEvent &t_event_)
+{
+    if (t_symbol_id_ >= books_.size())
+    {
+        return false;
+    }
+
+    EngineEvent engine_event;
+    engine_event.symbol_id = t_symbol_id_;
+    engine_event.reserved = 0;
+    engine_event.event = t_event_;
+
+    SPSCQueue<EngineEvent> &queue = *workers_[GetWorkerIndex(t_symbol_id_)].queue_;
+    while (!queue.TryPush(engine_event))
+    {
+        CpuRelax();
+    }
+    return true;
+}
+
+void BookEngine::BuildBooks(int t_worker_index_)
+{
+    for (uint32_t symbol_id = 0; symbol_id < books_.size(); symbol_id++)
+    {
+        if (GetWorkerIndex(symbol_id) != t_worker_index_ || books_[symbol_id])
+        {
+            continue;
+        }
+        const SymbolConfig &symbol_config = symbol_configs_[symbol_id];
+        arenas_[symbol_id].reset(
+            new BookArena(OrderBookManager::GetMemorySize(symbol_config.max_live_orders_, symbol_config.l3_mode_)));
+        ScopedBookMemoryResource book_memory(arenas_[symbol_id].get());
+        books_[symbol_id].reset(new OrderBook(symbol_config.symbol_, symbol_config.min_price_increment_));
+        managers_[symbol_id].reset(
+            new OrderBookManager(*books_[symbol_id], symbol_config.max_live_orders_, symbol_config.l3_mode_));
+    }
+}
+
+void BookEngine::RunWorker(int t_worker_index_)
+{
+    if (first_cpu_ >= 0)
+    {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(first_cpu_ + t_worker_index_, &cpu_set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+        {
+            std::cout << " Could not pin worker " << t_worker_index_ << " to cpu " << first_cpu_ + t_worker_index_
+                      << ", running unpinned\n";
+        }
+    }
+
+    // after pinning, so the pages land on this cpu's node
+    BuildBooks(t_worker_index_);
+    num_ready_workers_.fetch_add(1, std::memory_order_release);
+
+    Worker &worker = workers_[t_worker_index_];
+    SPSCQueue<EngineEvent> &queue = *worker.queue_;
+    EngineEvent engine_event;
+    uint64_t num_events = 0;
+
+    while (true)
+    {
+        if (queue.TryPop(engine_event))
+        {
+            managers_[engine_event.symbol_id]->OnEvent(engine_event.event);
+            num_events++;
+            continue;
+        }
+
+        if (!is_running_.load(std::memory_order_acquire))
+        {
+            // everything submitted before Stop is visible now, finish it
+            while (queue.TryPop(engine_event))
+            {
+                managers_[engine_event.symbol_id]->OnEvent(engine_event.event);
+                num_events++;
+            }
+            break;
+        }
+        CpuRelax();
+    }
+
+    worker.num_events_ += num_events;
+}
@@ -0,0 +1,101 @@
+#ifndef BOOK_ENGINE_HPP
+#define BOOK_ENGINE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "order_book_manager.hpp"
+#include "spsc_queue.hpp"
+
+#define DEFAULT_ENGINE_QUEUE_CAPACITY (1 << 16)
+
+// An order event routed to the book of one symbol
+struct EngineEvent
+{
+    uint32_t symbol_id;
+    uint32_t reserved;
+    OrderEvent event;
+};
+
+/*
+ * Many books, one per symbol, spread over worker threads.
+ *
+ * Symbols get dense ids (0, 1, 2, ...) from AddSymbol, and symbol id % num_workers
+ * picks the worker that owns the book, so a book is only ever touched by one thread
+ * and its events are handled in the order they were submitted. A single router thread
+ * (the one calling Submit) feeds every worker through its own SPSCQueue; workers are
+ * pinned to consecutive cpus starting at @t_first_cpu_ and busy poll their queue.
+ *
+ * Every book is built by the worker that owns it, once pinned, in a BookArena of its own, so
+ * its memory is faulted in on that worker's cpu and NUMA node and not on the router's.
+ *
+ * Usage: AddSymbol for every symbol, Start, Submit from one thread, Stop. The books exist
+ * once Start returns, and can be read (GetBook/GetManager) after Stop.
+ */
+class BookEngine
+{
+  private:
+    struct Worker
+    {
+        std::unique_ptr<SPSCQueue<EngineEvent> > queue_;
+        std::thread thread_;
+        uint64_t num_events_; // handled by this worker, written by the worker thread only
+    };
+
+    // what AddSymbol was given, the book is built from it by its worker
+    struct SymbolConfig
+    {
+        std::string symbol_;
+        double min_price_increment_;
+        size_t max_live_orders_;
+        bool l3_mode_;
+    };
+
+    std::vector<SymbolConfig> symbol_configs_;
+    // before the books, so they are destroyed after them
+    std::vector<std::unique_ptr<BookArena> > arenas_;
+    std::vector<std::unique_ptr<OrderBook> > books_;
+    std::vector<std::unique_ptr<OrderBookManager> > managers_;
+    std::vector<Worker> workers_;
+
+    int first_cpu_;
+    std::atomic<bool> is_running_;
+    std::atomic<int> num_ready_workers_; // workers done building their books since Start
+
+    // worker thread, the books of its symbols not built yet
+    void BuildBooks(int t_worker_index_);
+    void RunWorker(int t_worker_index_);
+
+  public:
+    // @t_first_cpu_ < 0 leaves the workers unpinned
+    BookEngine(int t_num_workers_, int t_first_cpu_ = -1, size_t t_queue_capacity_ = DEFAULT_ENGINE_QUEUE_CAPACITY);
+    ~BookEngine();
+
+    // not once started, returns the dense id of the new symbol. The book is built by Start
+    uint32_t AddSymbol(const std::string &t_symbol_, double t_min_price_increment_,
+                       size_t t_max_live_orders_ = DEFAULT_MAX_LIVE_ORDERS, bool t_l3_mode_ = false);
+
+    // returns once every worker is pinned and has built its books
+    void Start();
+
+    // lets the workers drain their queues and joins them
+    void Stop();
+
+    // router thread only. Spins while the worker's queue is full, so a slow symbol backs up its
+    // router instead of dropping events. False for an unknown symbol id.
+    bool Submit(uint32_t t_symbol_id_, const OrderEvent &t_event_);
+
+    int GetWorkerIndex(uint32_t t_symbol_id_) const { return t_symbol_id_ % workers_.size(); }
+    size_t GetNumSymbols() const { return books_.size(); }
+    int GetNumWorkers() const { return workers_.size(); }
+    uint64_t GetWorkerEvents(int t_worker_index_) const { return workers_[t_worker_index_].num_events_; }
+
+    OrderBook &GetBook(uint32_t t_symbol_id_) { return *books_[t_symbol_id_]; }
+    OrderBookManager &GetManager(uint32_t t_symbol_id_) { return *managers_[t_symbol_id_]; }
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "book_log.hpp"
+
+#include <chrono>
+
+#define LOG_IDLE_SLEEP_US 100
+
+static const char *GetSideName(uint8_t t_side_)
+{
+    return (t_side_ == 'B' ? "Bid" : (t_side_ == 'S' ? "Ask" : "?"));
+}
+
+const char *GetBookAnomalyName(BookAnomaly t_anomaly_)
+{
+    switch (t_anomaly_)
+    {
+    case BOOK_ANOMALY_DUPLICATE_ORDER:
+        return "duplicate_order";
+    case BOOK_ANOMALY_ORDER_MAP_FULL:
+        return "order_map_full";
+    case BOOK_ANOMALY_UNKNOWN_DELETE:
+        return "unknown_delete";
+    case BOOK_ANOMALY_UNKNOWN_MODIFY:
+        return "unknown_modify";
+    case BOOK_ANOMALY_UNKNOWN_REPLACE:
+        return "unknown_replace";
+    case BOOK_ANOMALY_UNKNOWN_EXEC:
+        return "unknown_exec";
+    case BOOK_ANOMALY_MODIFY_NOT_STORED:
+        return "modify_not_stored";
+    case BOOK_ANOMALY_NODE_POOL_EXHAUSTED:
+        return "node_pool_exhausted";
+    case BOOK_ANOMALY_INVALID_SIDE:
+        return "invalid_side";
+    case BOOK_ANOMALY_UNKNOWN_EVENT_TYPE:
+        return "unknown_event_type";
+    case BOOK_ANOMALY_BOOK_RESET:
+        return "book_reset";
+    default:
+        return "unknown";
+    }
+}
+
+void FormatLogRecord(std::ostream &t_out_, const LogRecord &t_record_)
+{
+    switch (t_record_.id)
+    {
+    case BOOK_ANOMALY_DUPLICATE_ORDER:
+        t_out_ << " " << GetSideName(t_record_.side) << " Order already present with order_id: " << t_record_.order_id;
+        break;
+    case BOOK_ANOMALY_ORDER_MAP_FULL:
+        t_out_ << " " << GetSideName(t_record_.side) << " order map is full, Ignoring this order with order_id :"
+               << t_record_.order_id;
+        break;
+    case BOOK_ANOMALY_UNKNOWN_DELETE:
+        t_out_ << " Error: " << GetSideName(t_record_.side) << " OrderId: " << t_record_.order_id
+               << " not present to delete.";
+        break;
+    case BOOK_ANOMALY_UNKNOWN_MODIFY:
+        t_out_ << " Error: " << GetSideName(t_record_.side) << " OrderId: " << t_record_.order_id
+               << " not present to modify.";
+        break;
+    case BOOK_ANOMALY_UNKNOWN_REPLACE:
+        t_out_ << " Error: " << GetSideName(t_record_.side) << " OrderId: " << t_record_.order_id
+               << " not present to replace.";
+        break;
+    case BOOK_ANOMALY_UNKNOWN_EXEC:
+        t_out_ << " Error: " << GetSideName(t_record_.side) << " OrderId: " << t_record_.order_id
+               << " not present to Exec.";
+        break;
+    case BOOK_ANOMALY_MODIFY_NOT_STORED:
+        t_out_ << " Error: " << GetSideName(t_record_.side) << " OrderId: " << t_record_.order_id
+               << " could not be stored, treating as deleted.";
+        break;
+    case BOOK_ANOMALY_NODE_POOL_EXHAUSTED:
+        t_out_ << " Order node pool is exhausted, order_id: " << t_record_.order_id << " is kept out of the L3 queue";
+        break;
+    case BOOK_ANOMALY_INVALID_SIDE:
+        t_out_ << " Invalid Side: " << (char)t_record_.value << " order_id: " << t_record_.order_id;
+        break;
+    case BOOK_ANOMALY_UNKNOWN_EVENT_TYPE:
+        t_out_ << " Unknown event type: " << t_record_.value << " order_id: " << t_record_.order_id;
+        break;
+    case BOOK_ANOMALY_BOOK_RESET:
+        t_out_ << " Resetting order book, flushing all the orders so far...";
+        break;
+    default:
+        t_out_ << " Unknown log record " << t_record_.id;
+        break;
+    }
+    t_out_ << "\n";
+}
+
+LogChannel *AsyncLogger::NewChannel(size_t t_capacity_)
+{
+    if (is_running_.load())
+    {
+        return nullptr;
+    }
+    channels_.push_back(std::unique_ptr<LogChannel>(new LogChannel(t_capacity_)));
+    return channels_.back().get();
+}
+
+void AsyncLogger::Start()
+{
+    if (is_running_.exchange(true))
+    {
+        return;
+    }
+    thread_ = std::thread(&AsyncLogger::Run, this);
+}
+
+void AsyncLogger::Stop()
+{
+    if (!is_running_.exchange(false))
+    {
+        return;
+    }
+    thread_.join();
+}
+
+uint64_t AsyncLogger::GetNumDropped() const
+{
+    uint64_t num_dropped = 0;
+    for (size_t index = 0; index < channels_.size(); index++)
+    {
+        num_dropped += channels_[index]->GetNumDropped();
+    }
+    return num_dropped;
+}
+
+size_t AsyncLogger::Drain()
+{
+    size_t num_written = 0;
+    LogRecord record;
+    for (size_t index = 0; index < channels_.size(); index++)
+    {
+        while (channels_[index]->TryPop(record))
+        {
+            FormatLogRecord(out_, record);
+            num_written++;
+        }
+    }
+    if (num_written > 0)
+    {
+        out_.flush();
+    }
+    return num_written;
+}
+
+void AsyncLogger::Run()
+{
+    while (is_running_.load(std::memory_order_acquire))
+    {
+        // logging is rare, sleep rather than spin on a core a book thread could use
+        if (Drain() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(LOG_IDLE_SLEEP_US));
+        }
+    }
+    Drain();
+}
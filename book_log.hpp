@@ -0,0 +1,118 @@
+#ifndef BOOK_LOG_HPP
+#define BOOK_LOG_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_queue.hpp"
+
+#define DEFAULT_LOG_CHANNEL_CAPACITY 4096
+
+// Everything the manager reports from its handlers, also the index of its anomaly counters
+enum BookAnomaly
+{
+    BOOK_ANOMALY_DUPLICATE_ORDER = 0, // add with an order id that is already live
+    BOOK_ANOMALY_ORDER_MAP_FULL,      // add that didn't fit in the live order map
+    BOOK_ANOMALY_UNKNOWN_DELETE,      // delete of an order id that isn't live
+    BOOK_ANOMALY_UNKNOWN_MODIFY,      // modify of an order id that isn't live
+    BOOK_ANOMALY_UNKNOWN_REPLACE,     // replace of an order id that isn't live
+    BOOK_ANOMALY_UNKNOWN_EXEC,        // exec of an order id that isn't live
+    BOOK_ANOMALY_MODIFY_NOT_STORED,   // modify to a new order id that didn't fit in the map, order dropped
+    BOOK_ANOMALY_NODE_POOL_EXHAUSTED, // L3 order kept out of its level queue
+    BOOK_ANOMALY_INVALID_SIDE,        // side is neither 'B' nor 'S'
+    BOOK_ANOMALY_UNKNOWN_EVENT_TYPE,  // OrderEvent with an unknown type
+    BOOK_ANOMALY_BOOK_RESET,          // OnOrderResetBegin flushed the book
+    NUM_BOOK_ANOMALIES
+};
+
+/*
+ * One log line as it sits in the ring: what happened and its raw arguments, formatted
+ * later by the logger thread. @value is the price, size, side or event type depending on @id.
+ */
+struct LogRecord
+{
+    uint32_t id;
+    uint8_t side;
+    uint8_t reserved[3];
+    uint64_t order_id;
+    int64_t value;
+};
+
+// short name of @t_anomaly_ for counter dumps, e.g. "unknown_delete"
+const char *GetBookAnomalyName(BookAnomaly t_anomaly_);
+
+// appends the text of @t_record_ to @t_out_, one line
+void FormatLogRecord(std::ostream &t_out_, const LogRecord &t_record_);
+
+/*
+ * The producer end a book thread logs into. Log copies 24 bytes into a lock-free
+ * ring and returns, it never allocates, formats or waits: when the logger thread
+ * falls behind and the ring is full the record is dropped and counted.
+ * Only one thread may log into a channel.
+ */
+class LogChannel
+{
+  private:
+    SPSCQueue<LogRecord> queue_;
+    std::atomic<uint64_t> num_dropped_;
+
+  public:
+    explicit LogChannel(size_t t_capacity_) : queue_(t_capacity_), num_dropped_(0) {}
+
+    void Log(uint32_t t_id_, uint8_t t_side_, uint64_t t_order_id_, int64_t t_value_)
+    {
+        LogRecord record;
+        record.id = t_id_;
+        record.side = t_side_;
+        record.reserved[0] = record.reserved[1] = record.reserved[2] = 0;
+        record.order_id = t_order_id_;
+        record.value = t_value_;
+        if (!queue_.TryPush(record))
+        {
+            num_dropped_.store(num_dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    // logger thread only
+    bool TryPop(LogRecord &t_record_) { return queue_.TryPop(t_record_); }
+
+    uint64_t GetNumDropped() const { return num_dropped_.load(std::memory_order_relaxed); }
+};
+
+/*
+ * Background thread that drains any number of LogChannels, formats the records and
+ * writes them to an ostream, flushing once per batch. Channels are handed out by
+ * NewChannel before Start; Stop writes out whatever is still queued.
+ */
+class AsyncLogger
+{
+  private:
+    std::ostream &out_;
+    std::vector<std::unique_ptr<LogChannel> > channels_;
+    std::thread thread_;
+    std::atomic<bool> is_running_;
+
+    // writes out what is queued, returns the number of records written
+    size_t Drain();
+    void Run();
+
+  public:
+    explicit AsyncLogger(std::ostream &t_out_) : out_(t_out_), channels_(), thread_(), is_running_(false) {}
+    ~AsyncLogger() { Stop(); }
+
+    // nullptr once the logger is running
+    LogChannel *NewChannel(size_t t_capacity_ = DEFAULT_LOG_CHANNEL_CAPACITY);
+
+    void Start();
+    void Stop();
+
+    // records dropped on full channels so far, over all channels
+    uint64_t GetNumDropped() const;
+};
+
+#endif
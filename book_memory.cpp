@@ -0,0 +1,166 @@
+#include "book_memory.hpp"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// from linux/mempolicy.h: prefer the given node, fall back to others when it is full
+#define BOOK_MPOL_PREFERRED 1
+
+static thread_local BookMemoryResource *book_memory_resource = nullptr;
+
+static size_t RoundUp(size_t t_num_bytes_, size_t t_multiple_)
+{
+    return (t_num_bytes_ + t_multiple_ - 1) / t_multiple_ * t_multiple_;
+}
+
+static bool IsLargeAllocation(size_t t_num_bytes_) { return t_num_bytes_ >= HUGE_PAGE_SIZE / 2; }
+
+static size_t GetMappedSize(size_t t_num_bytes_)
+{
+    return RoundUp((t_num_bytes_ > 0 ? t_num_bytes_ : 1), (IsLargeAllocation(t_num_bytes_) ? HUGE_PAGE_SIZE : SMALL_PAGE_SIZE));
+}
+
+// nothing is lost if this fails (no NUMA, syscall filtered), the pages are just wherever first touch puts them
+static void BindToLocalNode(void *t_ptr_, size_t t_num_bytes_)
+{
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 || node >= 8 * sizeof(unsigned long))
+    {
+        return;
+    }
+    unsigned long node_mask = 1ul << node;
+    syscall(SYS_mbind, t_ptr_, t_num_bytes_, BOOK_MPOL_PREFERRED, &node_mask, 8 * sizeof(node_mask) + 1, 0);
+}
+
+void *HugePageMemoryResource::Allocate(size_t t_num_bytes_)
+{
+    const size_t mapped_size = GetMappedSize(t_num_bytes_);
+    const int protection = PROT_READ | PROT_WRITE;
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+    std::atomic<uint64_t> *counter = &small_page_bytes_;
+    void *ptr = MAP_FAILED;
+    if (IsLargeAllocation(t_num_bytes_))
+    {
+        ptr = mmap(nullptr, mapped_size, protection, flags | MAP_HUGETLB, -1, 0);
+        counter = &huge_page_bytes_;
+    }
+    if (ptr == MAP_FAILED)
+    {
+        ptr = mmap(nullptr, mapped_size, protection, flags, -1, 0);
+        if (ptr == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+        if (IsLargeAllocation(t_num_bytes_))
+        {
+            madvise(ptr, mapped_size, MADV_HUGEPAGE);
+            counter = &transparent_huge_page_bytes_;
+        }
+        else
+        {
+            counter = &small_page_bytes_;
+        }
+    }
+
+    BindToLocalNode(ptr, mapped_size);
+
+    // fault every page in now, on this thread
+    volatile char *bytes = static_cast<volatile char *>(ptr);
+    for (size_t offset = 0; offset < mapped_size; offset += SMALL_PAGE_SIZE)
+    {
+        bytes[offset] = 0;
+    }
+
+    counter->fetch_add(mapped_size, std::memory_order_relaxed);
+    return ptr;
+}
+
+void HugePageMemoryResource::Deallocate(void *t_ptr_, size_t t_num_bytes_)
+{
+    if (t_ptr_ == nullptr)
+    {
+        return;
+    }
+    munmap(t_ptr_, GetMappedSize(t_num_bytes_));
+}
+
+void *HeapMemoryResource::Allocate(size_t t_num_bytes_)
+{
+    // operator new only promises 16 bytes
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, BOOK_MEMORY_ALIGNMENT, (t_num_bytes_ > 0 ? t_num_bytes_ : 1)) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+BookArena::BookArena(size_t t_capacity_, BookMemoryResource *t_upstream_)
+    : upstream_(t_upstream_),
+      begin_(nullptr),
+      capacity_(GetBookAllocationSize(t_capacity_)),
+      used_(0)
+{
+    if (capacity_ > 0)
+    {
+        begin_ = static_cast<char *>(upstream_->Allocate(capacity_));
+    }
+}
+
+BookArena::~BookArena()
+{
+    if (begin_ != nullptr)
+    {
+        upstream_->Deallocate(begin_, capacity_);
+    }
+}
+
+void *BookArena::Allocate(size_t t_num_bytes_)
+{
+    const size_t num_bytes = GetBookAllocationSize(t_num_bytes_);
+    if (num_bytes > capacity_ - used_)
+    {
+        return upstream_->Allocate(t_num_bytes_);
+    }
+    void *ptr = begin_ + used_;
+    used_ += num_bytes;
+    return ptr;
+}
+
+void BookArena::Deallocate(void *t_ptr_, size_t t_num_bytes_)
+{
+    if (t_ptr_ == nullptr)
+    {
+        return;
+    }
+    if (!Owns(t_ptr_))
+    {
+        upstream_->Deallocate(t_ptr_, t_num_bytes_);
+        return;
+    }
+    // the rest stays until the arena goes
+    const size_t num_bytes = GetBookAllocationSize(t_num_bytes_);
+    if (static_cast<char *>(t_ptr_) + num_bytes == begin_ + used_)
+    {
+        used_ -= num_bytes;
+    }
+}
+
+HugePageMemoryResource &GetHugePageMemoryResource()
+{
+    static HugePageMemoryResource resource;
+    return resource;
+}
+
+BookMemoryResource *GetBookMemoryResource()
+{
+    return (book_memory_resource != nullptr ? book_memory_resource : &GetHugePageMemoryResource());
+}
+
+void SetBookMemoryResource(BookMemoryResource *t_resource_)
+{
+    book_memory_resource = t_resource_;
+}
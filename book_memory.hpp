@@ -0,0 +1,178 @@
+#ifndef BOOK_MEMORY_HPP
+#define BOOK_MEMORY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#define SMALL_PAGE_SIZE (4096u)
+#define HUGE_PAGE_SIZE (2u << 20)
+#define BOOK_MEMORY_ALIGNMENT 64
+
+/*
+ * Where the fixed size storage of a book comes from: the ladder arrays, the order map slots
+ * and the L3 node pool. It is only asked while a book is built (or a map is sized), never
+ * while events are processed, so the virtual call costs nothing on the hot path.
+ */
+class BookMemoryResource
+{
+  public:
+    virtual ~BookMemoryResource() {}
+
+    // has to return memory aligned to at least a cache line (BOOK_MEMORY_ALIGNMENT), or throw std::bad_alloc
+    virtual void *Allocate(size_t t_num_bytes_) = 0;
+    virtual void Deallocate(void *t_ptr_, size_t t_num_bytes_) = 0;
+};
+
+// @t_num_bytes_ rounded up to BOOK_MEMORY_ALIGNMENT, what a BookArena hands out for it
+inline size_t GetBookAllocationSize(size_t t_num_bytes_)
+{
+    return (t_num_bytes_ + BOOK_MEMORY_ALIGNMENT - 1) / BOOK_MEMORY_ALIGNMENT * BOOK_MEMORY_ALIGNMENT;
+}
+
+/*
+ * The default resource. Every allocation is its own anonymous mapping:
+ *  - at least half a huge page: 2 MB huge pages (MAP_HUGETLB) if the system has any reserved,
+ *    transparent huge pages (madvise) otherwise
+ *  - smaller: plain 4 KB pages
+ * The mapping is bound to the NUMA node of the calling thread (best effort) and every page is
+ * written once before it is handed out, so no page fault or remote access is left for the first event.
+ * Build a book on the thread, or at least the node, that will feed it. A book has a dozen arrays,
+ * most of them a few KB, so give it a BookArena on top of this rather than a mapping per array.
+ */
+class HugePageMemoryResource : public BookMemoryResource
+{
+  private:
+    std::atomic<uint64_t> huge_page_bytes_;
+    std::atomic<uint64_t> transparent_huge_page_bytes_;
+    std::atomic<uint64_t> small_page_bytes_;
+
+  public:
+    HugePageMemoryResource() : huge_page_bytes_(0), transparent_huge_page_bytes_(0), small_page_bytes_(0) {}
+
+    void *Allocate(size_t t_num_bytes_);
+    void Deallocate(void *t_ptr_, size_t t_num_bytes_);
+
+    // bytes mapped of each kind so far, freed mappings included
+    uint64_t GetHugePageBytes() const { return huge_page_bytes_.load(std::memory_order_relaxed); }
+    uint64_t GetTransparentHugePageBytes() const { return transparent_huge_page_bytes_.load(std::memory_order_relaxed); }
+    uint64_t GetSmallPageBytes() const { return small_page_bytes_.load(std::memory_order_relaxed); }
+};
+
+// the heap, cache line aligned, for hosts where mapping memory per book is not wanted
+class HeapMemoryResource : public BookMemoryResource
+{
+  public:
+    void *Allocate(size_t t_num_bytes_);
+    void Deallocate(void *t_ptr_, size_t) { free(t_ptr_); }
+};
+
+// the process wide HugePageMemoryResource
+HugePageMemoryResource &GetHugePageMemoryResource();
+
+/*
+ * All the arrays of one book (ladders, order maps, node pool) carved out of a single allocation
+ * of the upstream resource: one mapping per book, sized with OrderBookManager::GetMemorySize,
+ * so huge pages are shared by the arrays and nothing is left of the pages but the rounding.
+ * Allocate bumps a pointer, Deallocate only gives back the last allocation, and the whole block
+ * goes back upstream when the arena is destroyed, so it has to outlive the book and its manager.
+ * Past the capacity allocations are passed upstream. Only the thread building the book uses it.
+ */
+class BookArena : public BookMemoryResource
+{
+  private:
+    BookMemoryResource *upstream_;
+    char *begin_;
+    size_t capacity_;
+    size_t used_;
+
+    bool Owns(const void *t_ptr_) const
+    {
+        return static_cast<const char *>(t_ptr_) >= begin_ && static_cast<const char *>(t_ptr_) < begin_ + capacity_;
+    }
+
+  public:
+    // takes @t_capacity_ bytes from @t_upstream_ now, on the calling thread
+    explicit BookArena(size_t t_capacity_, BookMemoryResource *t_upstream_ = &GetHugePageMemoryResource());
+    ~BookArena();
+
+    BookArena(const BookArena &) = delete;
+    BookArena &operator=(const BookArena &) = delete;
+
+    void *Allocate(size_t t_num_bytes_);
+    void Deallocate(void *t_ptr_, size_t t_num_bytes_);
+
+    size_t GetCapacity() const { return capacity_; }
+    size_t GetUsedBytes() const { return used_; }
+};
+
+// resource books built from now on by the calling thread allocate from, the HugePageMemoryResource unless set
+BookMemoryResource *GetBookMemoryResource();
+
+// for the calling thread, nullptr restores the default. Containers keep the resource they were
+// built with, so this only affects books built afterwards, and @t_resource_ has to outlive those
+void SetBookMemoryResource(BookMemoryResource *t_resource_);
+
+// SetBookMemoryResource for the lifetime of the object, the previous resource is restored after
+class ScopedBookMemoryResource
+{
+  private:
+    BookMemoryResource *previous_;
+
+  public:
+    explicit ScopedBookMemoryResource(BookMemoryResource *t_resource_) : previous_(GetBookMemoryResource())
+    {
+        SetBookMemoryResource(t_resource_);
+    }
+    ~ScopedBookMemoryResource() { SetBookMemoryResource(previous_); }
+
+    ScopedBookMemoryResource(const ScopedBookMemoryResource &) = delete;
+    ScopedBookMemoryResource &operator=(const ScopedBookMemoryResource &) = delete;
+};
+
+/*
+ * std allocator over a BookMemoryResource, picked up when the container is constructed.
+ * Containers of a book use it through BookVector.
+ */
+template <typename T>
+class BookAllocator
+{
+  public:
+    typedef T value_type;
+
+    BookMemoryResource *resource_;
+
+    BookAllocator() : resource_(GetBookMemoryResource()) {}
+
+    template <typename U>
+    BookAllocator(const BookAllocator<U> &t_other_) : resource_(t_other_.resource_)
+    {
+    }
+
+    T *allocate(size_t t_num_elements_)
+    {
+        return static_cast<T *>(resource_->Allocate(t_num_elements_ * sizeof(T)));
+    }
+
+    void deallocate(T *t_ptr_, size_t t_num_elements_) { resource_->Deallocate(t_ptr_, t_num_elements_ * sizeof(T)); }
+};
+
+template <typename T, typename U>
+bool operator==(const BookAllocator<T> &t_lhs_, const BookAllocator<U> &t_rhs_)
+{
+    return t_lhs_.resource_ == t_rhs_.resource_;
+}
+
+template <typename T, typename U>
+bool operator!=(const BookAllocator<T> &t_lhs_, const BookAllocator<U> &t_rhs_)
+{
+    return t_lhs_.resource_ != t_rhs_.resource_;
+}
+
+template <typename T>
+using BookVector = std::vector<T, BookAllocator<T> >;
+
+#endif
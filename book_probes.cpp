@@ -0,0 +1,118 @@
+#include "book_probes.hpp"
+
+#include <cstdio>
+#include <mutex>
+
+#define TSC_CALIBRATION_MS 20
+
+const char *GetBookProbeName(BookProbe t_probe_)
+{
+    switch (t_probe_)
+    {
+    case BOOK_PROBE_ADD:
+        return "add";
+    case BOOK_PROBE_DELETE:
+        return "delete";
+    case BOOK_PROBE_MODIFY:
+        return "modify";
+    case BOOK_PROBE_REPLACE:
+        return "replace";
+    case BOOK_PROBE_EXEC:
+        return "exec";
+    case BOOK_PROBE_LEVEL_UPDATE:
+        return "level_update";
+    case BOOK_PROBE_LEVEL_DELETE:
+        return "level_delete";
+    case BOOK_PROBE_ORDER_LOOKUP:
+        return "order_lookup";
+    case BOOK_PROBE_LADDER_UPDATE:
+        return "ladder_update";
+    case BOOK_PROBE_BASE_INDEX:
+        return "base_index";
+    case BOOK_PROBE_REBUILD_HIGH:
+        return "rebuild_high";
+    case BOOK_PROBE_REBUILD_LOW:
+        return "rebuild_low";
+    case BOOK_PROBE_MATCH:
+        return "match";
+    case BOOK_PROBE_PUBLISH:
+        return "publish";
+    default:
+        return "unknown";
+    }
+}
+
+const char *GetBookPathName(BookPath t_path_)
+{
+    switch (t_path_)
+    {
+    case BOOK_PATH_REBUILD_HIGH:
+        return "rebuild_high";
+    case BOOK_PATH_REBUILD_LOW:
+        return "rebuild_low";
+    case BOOK_PATH_OVERFLOW_SPILL:
+        return "overflow_spill";
+    case BOOK_PATH_OVERFLOW_ADD:
+        return "overflow_add";
+    case BOOK_PATH_SIDE_EMPTIED:
+        return "side_emptied";
+    case BOOK_PATH_IGNORED_EVENT:
+        return "ignored_event";
+    default:
+        return "unknown";
+    }
+}
+
+static double tsc_ticks_per_ns = 0.0;
+static std::once_flag tsc_calibration_flag;
+
+static void CalibrateTsc()
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const uint64_t start_ticks = ReadTsc();
+    std::chrono::steady_clock::time_point end = start;
+    while (end - start < std::chrono::milliseconds(TSC_CALIBRATION_MS))
+    {
+        end = std::chrono::steady_clock::now();
+    }
+    const uint64_t end_ticks = ReadTsc();
+    const double elapsed_ns = std::chrono::duration<double, std::nano>(end - start).count();
+    tsc_ticks_per_ns = (end_ticks > start_ticks ? (end_ticks - start_ticks) / elapsed_ns : 1.0);
+}
+
+double GetTscTicksPerNs()
+{
+    std::call_once(tsc_calibration_flag, CalibrateTsc);
+    return tsc_ticks_per_ns;
+}
+
+void DumpBookProbes(const BookProbes &t_probes_, std::ostream &t_stream_)
+{
+    const double ticks_per_ns = GetTscTicksPerNs();
+    char line[160];
+
+    snprintf(line, sizeof(line), "  %-15s %10s %8s %8s %8s %8s %10s\n", "probe (ns)", "count", "mean", "p50", "p99",
+             "p99.9", "max");
+    t_stream_ << line;
+    for (int probe = 0; probe < NUM_BOOK_PROBES; probe++)
+    {
+        const LatencyHistogram &histogram = t_probes_.histograms_[probe];
+        if (histogram.GetCount() == 0)
+        {
+            continue;
+        }
+        snprintf(line, sizeof(line), "  %-15s %10llu %8.0f %8.0f %8.0f %8.0f %10.0f\n",
+                 GetBookProbeName((BookProbe)probe), (unsigned long long)histogram.GetCount(),
+                 histogram.GetMean() / ticks_per_ns, histogram.GetPercentile(50.0) / ticks_per_ns,
+                 histogram.GetPercentile(99.0) / ticks_per_ns, histogram.GetPercentile(99.9) / ticks_per_ns,
+                 histogram.GetMax() / ticks_per_ns);
+        t_stream_ << line;
+    }
+
+    for (int path = 0; path < NUM_BOOK_PATHS; path++)
+    {
+        snprintf(line, sizeof(line), "  %-15s %10llu\n", GetBookPathName((BookPath)path),
+                 (unsigned long long)t_probes_.GetCount((BookPath)path));
+        t_stream_ << line;
+    }
+}
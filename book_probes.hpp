@@ -0,0 +1,164 @@
+#ifndef BOOK_PROBES_HPP
+#define BOOK_PROBES_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "latency_histogram.hpp"
+
+// 1 builds the latency probes into the book and the handlers, 0 leaves no trace of them.
+// It changes the layout of OrderBook, so set it for the whole build (-DLATENCY_PROBES_ON=1)
+#ifndef LATENCY_PROBES_ON
+#define LATENCY_PROBES_ON 0
+#endif
+
+// Timed sections. A phase includes the phases it calls, e.g. a rebuild inside a ladder update
+enum BookProbe
+{
+    // whole handlers, from the public entry point
+    BOOK_PROBE_ADD = 0,
+    BOOK_PROBE_DELETE,
+    BOOK_PROBE_MODIFY,
+    BOOK_PROBE_REPLACE,
+    BOOK_PROBE_EXEC,
+    BOOK_PROBE_LEVEL_UPDATE,
+    BOOK_PROBE_LEVEL_DELETE,
+    // phases of the handlers
+    BOOK_PROBE_ORDER_LOOKUP,  // order map Find/Insert
+    BOOK_PROBE_LADDER_UPDATE, // level (and queue) write of an order, window preparation included
+    BOOK_PROBE_BASE_INDEX,    // UpdateBaseIndex, looking for the next best level
+    BOOK_PROBE_REBUILD_HIGH,  // RebuildIndexHighAccess
+    BOOK_PROBE_REBUILD_LOW,   // RebuildIndexLowAccess
+    BOOK_PROBE_MATCH,         // MatchOrder, matching mode only
+    BOOK_PROBE_PUBLISH,       // PublishTopOfBook
+    NUM_BOOK_PROBES
+};
+
+// Paths that are rare in a healthy feed, counted when taken
+enum BookPath
+{
+    BOOK_PATH_REBUILD_HIGH = 0, // window slid up to a better price
+    BOOK_PATH_REBUILD_LOW,      // window slid down
+    BOOK_PATH_OVERFLOW_SPILL,   // level rolled out of the window into the overflow tier
+    BOOK_PATH_OVERFLOW_ADD,     // order added behind the window
+    BOOK_PATH_SIDE_EMPTIED,     // last level of a side went
+    BOOK_PATH_IGNORED_EVENT,    // event dropped before the book was up, without an anomaly
+    NUM_BOOK_PATHS
+};
+
+const char *GetBookProbeName(BookProbe t_probe_);
+const char *GetBookPathName(BookPath t_path_);
+
+// time stamp counter, steady_clock nanoseconds where there is none
+inline uint64_t ReadTsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+// ReadTsc ticks per nanosecond, measured against steady_clock once, by the first caller of any
+// thread (takes ~20 ms), the others wait for it
+double GetTscTicksPerNs();
+
+/*
+ * Per book latency histograms (in ReadTsc ticks) of every BookProbe and counts of every BookPath.
+ * Memory is fixed, a sample is a read of the time stamp counter and a histogram Record.
+ * Only the thread feeding the book writes. Other threads may read it at any time, e.g. through
+ * DumpBookProbes, without a lock: every count is a relaxed atomic (see LatencyHistogram), so it
+ * is never torn, but counts of different buckets may be an event or so apart.
+ */
+struct BookProbes
+{
+    LatencyHistogram histograms_[NUM_BOOK_PROBES];
+    std::atomic<uint64_t> path_counts_[NUM_BOOK_PATHS];
+
+    BookProbes() { Reset(); }
+
+    BookProbes(const BookProbes &t_other_) { *this = t_other_; }
+
+    // a copy of what @t_other_ holds now, e.g. to dump once its book is gone
+    BookProbes &operator=(const BookProbes &t_other_)
+    {
+        for (int probe = 0; probe < NUM_BOOK_PROBES; probe++)
+        {
+            histograms_[probe] = t_other_.histograms_[probe];
+        }
+        for (int path = 0; path < NUM_BOOK_PATHS; path++)
+        {
+            path_counts_[path].store(t_other_.GetCount((BookPath)path), std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    // from the thread feeding the book
+    void Reset()
+    {
+        for (int probe = 0; probe < NUM_BOOK_PROBES; probe++)
+        {
+            histograms_[probe].Reset();
+        }
+        for (int path = 0; path < NUM_BOOK_PATHS; path++)
+        {
+            path_counts_[path].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Record(BookProbe t_probe_, uint64_t t_ticks_) { histograms_[t_probe_].Record(t_ticks_); }
+
+    void Count(BookPath t_path_) { LatencyHistogram::Add(path_counts_[t_path_], 1); }
+
+    uint64_t GetCount(BookPath t_path_) const { return path_counts_[t_path_].load(std::memory_order_relaxed); }
+};
+
+// one line per probe that has samples (count, mean, p50/p99/p99.9/max in ns), then the path counts
+void DumpBookProbes(const BookProbes &t_probes_, std::ostream &t_stream_);
+
+// records the ticks from construction to the end of the scope
+class BookProbeScope
+{
+  private:
+    BookProbes &probes_;
+    BookProbe probe_;
+    uint64_t start_;
+
+  public:
+    BookProbeScope(BookProbes &t_probes_, BookProbe t_probe_) : probes_(t_probes_), probe_(t_probe_), start_(ReadTsc())
+    {
+    }
+
+    ~BookProbeScope() { probes_.Record(probe_, ReadTsc() - start_); }
+};
+
+/*
+ * What the book and the handlers use, so that with LATENCY_PROBES_ON 0 the probes compile to nothing
+ * and their arguments are never evaluated:
+ *  BOOK_PROBE_SCOPE(probes, probe)         times the rest of the enclosing scope
+ *  BOOK_PROBE_START(name)                  starts a section ...
+ *  BOOK_PROBE_STOP(probes, probe, name)    ... and records it, for sections that aren't a scope
+ *  BOOK_PROBE_COUNT(probes, path)          counts a rare path
+ */
+#if LATENCY_PROBES_ON
+#define BOOK_PROBE_CONCAT_IMPL(a, b) a##b
+#define BOOK_PROBE_CONCAT(a, b) BOOK_PROBE_CONCAT_IMPL(a, b)
+#define BOOK_PROBE_SCOPE(t_probes_, t_probe_) \
+    BookProbeScope BOOK_PROBE_CONCAT(book_probe_scope_, __LINE__)((t_probes_), (t_probe_))
+#define BOOK_PROBE_START(t_name_) const uint64_t t_name_ = ReadTsc()
+#define BOOK_PROBE_STOP(t_probes_, t_probe_, t_name_) (t_probes_).Record((t_probe_), ReadTsc() - (t_name_))
+#define BOOK_PROBE_COUNT(t_probes_, t_path_) (t_probes_).Count(t_path_)
+#else
+#define BOOK_PROBE_SCOPE(t_probes_, t_probe_)
+#define BOOK_PROBE_START(t_name_)
+#define BOOK_PROBE_STOP(t_probes_, t_probe_, t_name_)
+#define BOOK_PROBE_COUNT(t_probes_, t_path_)
+#endif
+
+#endif
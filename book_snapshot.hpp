@@ -0,0 +1,41 @@
+#ifndef BOOK_SNAPSHOT_HPP
+#define BOOK_SNAPSHOT_HPP
+
+// Deepest book a snapshot can hold per side
+#define BOOK_SNAPSHOT_MAX_LEVELS 10
+
+struct SnapshotLevel
+{
+    int int_price;  // price in ticks
+    int size;       // cumulative size at this level
+    int ordercount; // cumulative count of orders at this level
+};
+
+/*
+ * Top of the book as plain data: the best non-empty levels of each side, best first,
+ * and the size weighted average price over them. Fixed size and trivially copyable, so
+ * it can live on the stack, be reused across calls or be copied out to other threads.
+ */
+struct BookSnapshot
+{
+    double min_price_increment; // price of a level is int_price * min_price_increment
+    int num_bid_levels;         // valid entries in bid_levels
+    int num_ask_levels;         // valid entries in ask_levels
+    SnapshotLevel bid_levels[BOOK_SNAPSHOT_MAX_LEVELS];
+    SnapshotLevel ask_levels[BOOK_SNAPSHOT_MAX_LEVELS];
+    double vwap_bid_price; // over the levels above, 0 when the side is empty
+    double vwap_ask_price;
+};
+
+// Best level of each side, all zero for an empty side
+struct BestBidOffer
+{
+    int bid_int_price;
+    int bid_size;
+    int bid_ordercount;
+    int ask_int_price;
+    int ask_size;
+    int ask_ordercount;
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef CPU_RELAX_HPP
+#define CPU_RELAX_HPP
+
+#include <thread>
+
+#define CACHE_LINE_SIZE 64
+
+// hint to the cpu that this is a spin-wait loop
+static inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+#endif
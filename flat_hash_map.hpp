@@ -0,0 +1,221 @@
+#ifndef FLAT_HASH_MAP_HPP
+#define FLAT_HASH_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "book_memory.hpp"
+
+// No key is ever more than this many slots away from its home slot
+#define FLAT_HASH_MAP_MAX_PROBE 64
+
+/*
+ * Open addressing hash map from uint64_t keys (order ids) to small POD values.
+ *
+ * All slots are allocated once in the constructor, sized for @t_reserve_ keys at a
+ * load factor of at most 1/2, so Insert/Find/Erase never touch the allocator.
+ * Collisions are resolved with Robin Hood linear probing: the table stays sorted by
+ * home slot within every run, which lets Erase shift the rest of the run back
+ * instead of leaving tombstones, and lets Find stop as soon as it meets a slot that
+ * is closer to its home than the key being looked for would be.
+ * Insert refuses a key (returns nullptr) rather than let any key end up more than
+ * FLAT_HASH_MAP_MAX_PROBE slots from home, so lookups are bounded in the worst case.
+ */
+template <typename ValueType>
+class FlatHashMap
+{
+  private:
+    struct Slot
+    {
+        uint64_t key_;
+        ValueType value_;
+        uint32_t probe_; // distance from the home slot + 1, 0 marks an empty slot
+    };
+
+    BookVector<Slot> slots_;
+    size_t mask_;
+    unsigned int shift_;
+    size_t size_;
+    size_t max_size_;
+
+    size_t GetHomeSlot(uint64_t t_key_) const
+    {
+        // fibonacci hashing, spreads sequential order ids over the whole table
+        return (size_t)((t_key_ * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    // smallest power of two, at least 16, that holds @t_reserve_ keys at a load factor of 1/2
+    static size_t GetCapacity(size_t t_reserve_, unsigned int &t_log_capacity_)
+    {
+        size_t capacity = 16;
+        t_log_capacity_ = 4;
+        while (capacity < 2 * t_reserve_)
+        {
+            capacity <<= 1;
+            t_log_capacity_++;
+        }
+        return capacity;
+    }
+
+  public:
+    explicit FlatHashMap(size_t t_reserve_)
+        : slots_(),
+          mask_(0),
+          shift_(0),
+          size_(0),
+          max_size_(0)
+    {
+        unsigned int log_capacity = 0;
+        const size_t capacity = GetCapacity(t_reserve_, log_capacity);
+
+        slots_.resize(capacity);
+        mask_ = capacity - 1;
+        shift_ = 64 - log_capacity;
+        max_size_ = capacity / 2;
+        Clear();
+    }
+
+    ValueType *Find(uint64_t t_key_)
+    {
+        size_t index = GetHomeSlot(t_key_);
+        for (uint32_t probe = 1; probe <= slots_[index].probe_; probe++)
+        {
+            if (slots_[index].key_ == t_key_)
+            {
+                return &slots_[index].value_;
+            }
+            index = (index + 1) & mask_;
+        }
+        return nullptr;
+    }
+
+    const ValueType *Find(uint64_t t_key_) const { return const_cast<FlatHashMap *>(this)->Find(t_key_); }
+
+    // pulls the home slot of @t_key_ towards the cache ahead of a Find/Insert/Erase, touches nothing
+    void Prefetch(uint64_t t_key_) const { __builtin_prefetch(&slots_[GetHomeSlot(t_key_)]); }
+
+    /*
+     * Returns the stored value, or nullptr if the key is already present, the map is at
+     * capacity, or the insert would push some key past FLAT_HASH_MAP_MAX_PROBE. The map
+     * is untouched in that case.
+     */
+    ValueType *Insert(uint64_t t_key_, const ValueType &t_value_)
+    {
+        if (size_ >= max_size_)
+        {
+            return nullptr;
+        }
+
+        // find where the key belongs: the first slot holding a key closer to its home
+        size_t index = GetHomeSlot(t_key_);
+        uint32_t probe = 1;
+        for (; probe <= slots_[index].probe_; probe++)
+        {
+            if (slots_[index].key_ == t_key_)
+            {
+                return nullptr;
+            }
+            index = (index + 1) & mask_;
+        }
+
+        if (probe > FLAT_HASH_MAP_MAX_PROBE)
+        {
+            return nullptr;
+        }
+
+        // the rest of the run moves one slot to the right, check none of it gets too far from home
+        size_t empty_index = index;
+        while (slots_[empty_index].probe_ != 0)
+        {
+            if (slots_[empty_index].probe_ >= FLAT_HASH_MAP_MAX_PROBE)
+            {
+                return nullptr;
+            }
+            empty_index = (empty_index + 1) & mask_;
+        }
+
+        while (empty_index != index)
+        {
+            size_t prev_index = (empty_index - 1) & mask_;
+            slots_[empty_index] = slots_[prev_index];
+            slots_[empty_index].probe_++;
+            empty_index = prev_index;
+        }
+
+        slots_[index].key_ = t_key_;
+        slots_[index].value_ = t_value_;
+        slots_[index].probe_ = probe;
+        size_++;
+        return &slots_[index].value_;
+    }
+
+    bool Erase(uint64_t t_key_)
+    {
+        size_t index = GetHomeSlot(t_key_);
+        uint32_t probe = 1;
+        for (; probe <= slots_[index].probe_; probe++)
+        {
+            if (slots_[index].key_ == t_key_)
+            {
+                break;
+            }
+            index = (index + 1) & mask_;
+        }
+
+        if (probe > slots_[index].probe_)
+        {
+            return false;
+        }
+
+        // backward shift: pull the rest of the run one slot closer to home
+        size_t next_index = (index + 1) & mask_;
+        while (slots_[next_index].probe_ > 1)
+        {
+            slots_[index] = slots_[next_index];
+            slots_[index].probe_--;
+            index = next_index;
+            next_index = (next_index + 1) & mask_;
+        }
+        slots_[index].probe_ = 0;
+        size_--;
+        return true;
+    }
+
+    // calls @t_function_(key, value) for every stored key, in no particular order
+    template <typename Function>
+    void ForEach(Function t_function_) const
+    {
+        for (size_t index = 0; index < slots_.size(); index++)
+        {
+            if (slots_[index].probe_ != 0)
+            {
+                t_function_(slots_[index].key_, slots_[index].value_);
+            }
+        }
+    }
+
+    void Clear()
+    {
+        for (size_t index = 0; index < slots_.size(); index++)
+        {
+            slots_[index].probe_ = 0;
+        }
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    size_t capacity() const { return max_size_; }
+
+    // what a map reserved for @t_reserve_ keys takes from its BookMemoryResource
+    static size_t GetMemorySize(size_t t_reserve_)
+    {
+        unsigned int log_capacity = 0;
+        return GetBookAllocationSize(GetCapacity(t_reserve_, log_capacity) * sizeof(Slot));
+    }
+};
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef ITCH_DECODER_HPP
+#define ITCH_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "order_book_manager.hpp"
+#include "price_parser.hpp"
+
+// Message types of the order book messages, laid out as in ITCH 5.0
+#define ITCH_MSG_ADD_ORDER 'A'
+#define ITCH_MSG_ADD_ORDER_MPID 'F'
+#define ITCH_MSG_ORDER_EXECUTED 'E'
+#define ITCH_MSG_ORDER_EXECUTED_WITH_PRICE 'C'
+#define ITCH_MSG_ORDER_CANCEL 'X'
+#define ITCH_MSG_ORDER_DELETE 'D'
+#define ITCH_MSG_ORDER_REPLACE 'U'
+
+// Length of each of them, without the 2 byte length prefix
+#define ITCH_ADD_ORDER_LENGTH 36
+#define ITCH_ADD_ORDER_MPID_LENGTH 40
+#define ITCH_ORDER_EXECUTED_LENGTH 31
+#define ITCH_ORDER_EXECUTED_WITH_PRICE_LENGTH 36
+#define ITCH_ORDER_CANCEL_LENGTH 23
+#define ITCH_ORDER_DELETE_LENGTH 19
+#define ITCH_ORDER_REPLACE_LENGTH 35
+
+// Prices are 4 byte integers with 4 implied decimals
+#define ITCH_PRICE_DECIMALS 4
+
+// Every message starts with type (1), stock locate (2), tracking number (2) and timestamp (6)
+#define ITCH_HEADER_LENGTH 11
+
+// What a decoder did with the messages it was given
+struct ItchDecoderStats
+{
+    uint64_t num_messages;        // whole messages seen
+    uint64_t num_dispatched;      // passed on to a manager
+    uint64_t num_skipped;         // not an order book message (system events, trades, directory...)
+    uint64_t num_unknown_symbols; // stock locate without a manager
+    uint64_t num_unknown_orders;  // cancel/delete/execute/replace of an order id no manager of the locate knows
+    uint64_t num_ignored;         // of a known order, but ignored by the manager as its book isn't up yet
+    uint64_t num_bad_prices;      // price off the tick grid of the symbol: adds and replaces are dropped, executions apply
+    uint64_t num_malformed;       // shorter than the layout of its type
+};
+
+/*
+ * Streaming decoder of length-prefixed (2 byte big-endian length, then the message) ITCH-style
+ * binary messages, the framing of a SoupBinTCP/MoldUDP64 payload or of a capture file.
+ *
+ * Fields are read in place from the buffer (a memory mapped file or a receive buffer), with one
+ * byte swap each, and the message goes straight to the manager of its stock locate: nothing is
+ * copied and nothing is allocated per message. Orders map one to one onto the handlers:
+ *  A/F add      -> OnOrderAddIntPx
+ *  D delete     -> OnOrderDelete
+ *  X cancel     -> OnOrderModify with the size left, same order id (OnOrderDelete if none is left)
+ *  E executed   -> OnOrderExecIntPx at the price of the order
+ *  C executed   -> OnOrderExecIntPx at the price of the execution
+ *  U replace    -> OnOrderReplaceIntPx
+ * Only adds carry a side. The other messages find their order once with FindOrder on the manager
+ * and hand it to the handlers that take the found OrderInfo, which don't look it up again.
+ * Prices are converted to ticks with the PriceParser of the symbol, exactly, without a double.
+ * Everything else is skipped. The decoder runs on the thread that feeds the managers.
+ */
+template <typename LevelListener>
+class BasicItchDecoder
+{
+  private:
+    struct ItchSymbol
+    {
+        BasicOrderBookManager<LevelListener> *manager_;
+        PriceParser price_parser_;
+
+        ItchSymbol() : manager_(nullptr), price_parser_(1.0) {}
+    };
+
+    // indexed by stock locate, which venues hand out densely from 1
+    std::vector<ItchSymbol> symbols_;
+    ItchDecoderStats stats_;
+
+    static uint16_t ReadUint16(const uint8_t *t_field_)
+    {
+        uint16_t value;
+        memcpy(&value, t_field_, sizeof(value));
+        return __builtin_bswap16(value);
+    }
+
+    static uint32_t ReadUint32(const uint8_t *t_field_)
+    {
+        uint32_t value;
+        memcpy(&value, t_field_, sizeof(value));
+        return __builtin_bswap32(value);
+    }
+
+    static uint64_t ReadUint64(const uint8_t *t_field_)
+    {
+        uint64_t value;
+        memcpy(&value, t_field_, sizeof(value));
+        return __builtin_bswap64(value);
+    }
+
+    static size_t GetMessageLength(uint8_t t_type_)
+    {
+        switch (t_type_)
+        {
+        case ITCH_MSG_ADD_ORDER:
+            return ITCH_ADD_ORDER_LENGTH;
+        case ITCH_MSG_ADD_ORDER_MPID:
+            return ITCH_ADD_ORDER_MPID_LENGTH;
+        case ITCH_MSG_ORDER_EXECUTED:
+            return ITCH_ORDER_EXECUTED_LENGTH;
+        case ITCH_MSG_ORDER_EXECUTED_WITH_PRICE:
+            return ITCH_ORDER_EXECUTED_WITH_PRICE_LENGTH;
+        case ITCH_MSG_ORDER_CANCEL:
+            return ITCH_ORDER_CANCEL_LENGTH;
+        case ITCH_MSG_ORDER_DELETE:
+            return ITCH_ORDER_DELETE_LENGTH;
+        case ITCH_MSG_ORDER_REPLACE:
+            return ITCH_ORDER_REPLACE_LENGTH;
+        default:
+            return 0;
+        }
+    }
+
+    bool ToIntPrice(const ItchSymbol &t_symbol_, const uint8_t *t_field_, int &t_int_price_)
+    {
+        if (!t_symbol_.price_parser_.FromFixedPoint(ReadUint32(t_field_), ITCH_PRICE_DECIMALS, t_int_price_))
+        {
+            stats_.num_bad_prices++;
+            return false;
+        }
+        return true;
+    }
+
+  public:
+    BasicItchDecoder() : symbols_() { memset(&stats_, 0, sizeof(stats_)); }
+
+    // messages of @t_stock_locate_ go to @t_manager_, whose book has a tick of @t_min_price_increment_.
+    // Set up every symbol before decoding, this is the only place that allocates
+    void SetSymbol(uint16_t t_stock_locate_, BasicOrderBookManager<LevelListener> &t_manager_,
+                   double t_min_price_increment_)
+    {
+        if (t_stock_locate_ >= symbols_.size())
+        {
+            symbols_.resize(t_stock_locate_ + 1);
+        }
+        symbols_[t_stock_locate_].manager_ = &t_manager_;
+        symbols_[t_stock_locate_].price_parser_ = PriceParser(t_min_price_increment_);
+    }
+
+    /*
+     * Decodes every whole length-prefixed message in [@t_data_, @t_data_ + @t_num_bytes_) in order.
+     * Returns the number of bytes consumed, short of @t_num_bytes_ only if the buffer ends in the
+     * middle of a message: the caller keeps those bytes and passes them again with what follows.
+     */
+    size_t Decode(const uint8_t *t_data_, size_t t_num_bytes_)
+    {
+        size_t offset = 0;
+        while (offset + 2 <= t_num_bytes_)
+        {
+            const size_t length = ReadUint16(t_data_ + offset);
+            if (offset + 2 + length > t_num_bytes_)
+            {
+                break;
+            }
+            DecodeMessage(t_data_ + offset + 2, length);
+            offset += 2 + length;
+        }
+        return offset;
+    }
+
+    // one message of @t_length_ bytes, without its length prefix
+    void DecodeMessage(const uint8_t *t_message_, size_t t_length_)
+    {
+        stats_.num_messages++;
+        if (t_length_ < ITCH_HEADER_LENGTH)
+        {
+            stats_.num_malformed++;
+            return;
+        }
+
+        const uint8_t type = t_message_[0];
+        const size_t layout_length = GetMessageLength(type);
+        if (layout_length == 0)
+        {
+            stats_.num_skipped++;
+            return;
+        }
+        if (t_length_ < layout_length)
+        {
+            stats_.num_malformed++;
+            return;
+        }
+
+        const uint16_t stock_locate = ReadUint16(t_message_ + 1);
+        if (stock_locate >= symbols_.size() || symbols_[stock_locate].manager_ == nullptr)
+        {
+            stats_.num_unknown_symbols++;
+            return;
+        }
+        const ItchSymbol &symbol = symbols_[stock_locate];
+        BasicOrderBookManager<LevelListener> &manager = *symbol.manager_;
+
+        const uint64_t order_id = ReadUint64(t_message_ + 11);
+        int int_price = 0;
+
+        if (type == ITCH_MSG_ADD_ORDER || type == ITCH_MSG_ADD_ORDER_MPID)
+        {
+            // order id, side (19), shares (20), stock (24), price (32)
+            if (!ToIntPrice(symbol, t_message_ + 32, int_price))
+            {
+                return;
+            }
+            manager.OnOrderAddIntPx(order_id, t_message_[19], int_price, (int)ReadUint32(t_message_ + 20));
+            stats_.num_dispatched++;
+            return;
+        }
+
+        OrderInfo *order_info = manager.FindOrder(order_id);
+        if (order_info == nullptr)
+        {
+            stats_.num_unknown_orders++;
+            return;
+        }
+
+        bool is_handled = false;
+        switch (type)
+        {
+        case ITCH_MSG_ORDER_DELETE:
+            is_handled = manager.OnOrderDelete(order_id, order_info);
+            break;
+        case ITCH_MSG_ORDER_CANCEL:
+        {
+            // cancelled shares (19)
+            const int size_left = order_info->size - (int)ReadUint32(t_message_ + 19);
+            if (size_left > 0)
+            {
+                is_handled = manager.OnOrderModify(order_id, order_info, size_left, order_id);
+            }
+            else
+            {
+                is_handled = manager.OnOrderDelete(order_id, order_info);
+            }
+            break;
+        }
+        case ITCH_MSG_ORDER_EXECUTED:
+            // executed shares (19), match number (23)
+            is_handled = manager.OnOrderExecIntPx(order_id, order_info, (int)ReadUint32(t_message_ + 19));
+            break;
+        case ITCH_MSG_ORDER_EXECUTED_WITH_PRICE:
+            // executed shares (19), match number (23), printable (31), execution price (32).
+            // The size comes off the order where it rests, so the execution price doesn't move the
+            // book: one off the tick grid is counted in num_bad_prices, the execution still applies
+            ToIntPrice(symbol, t_message_ + 32, int_price);
+            is_handled = manager.OnOrderExecIntPx(order_id, order_info, (int)ReadUint32(t_message_ + 19));
+            break;
+        case ITCH_MSG_ORDER_REPLACE:
+            // new order id (19), shares (27), price (31)
+            if (!ToIntPrice(symbol, t_message_ + 31, int_price))
+            {
+                return;
+            }
+            is_handled = manager.OnOrderReplaceIntPx(order_id, order_info, int_price,
+                                                     (int)ReadUint32(t_message_ + 27), ReadUint64(t_message_ + 19));
+            break;
+        default:
+            break;
+        }
+        if (is_handled)
+        {
+            stats_.num_dispatched++;
+        }
+        else
+        {
+            stats_.num_ignored++;
+        }
+    }
+
+    const ItchDecoderStats &GetStats() const { return stats_; }
+};
+
+typedef BasicItchDecoder<NullLevelListener> ItchDecoder;
+
+#endif
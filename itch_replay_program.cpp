@@ -0,0 +1,110 @@
+#include "itch_decoder.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+/*
+ * Replays a capture of length-prefixed ITCH-style messages (see itch_decoder.hpp) into one
+ * book per stock locate given on the command line, messages of any other locate are skipped.
+ * The file is memory mapped and decoded in place, and the wall time, messages/sec and what
+ * the decoder did with the messages are reported at the end, along with the top of every book.
+ */
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <itch_file> <min_price_increment> <stock_locate> [stock_locate]...\n";
+        return 1;
+    }
+
+    const char *itch_file = argv[1];
+    double min_price_increment = atof(argv[2]);
+    if (min_price_increment <= 0.0)
+    {
+        std::cerr << "min_price_increment has to be positive\n";
+        return 1;
+    }
+
+    int fd = open(itch_file, O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Could not open " << itch_file << "\n";
+        return 1;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+    {
+        std::cerr << itch_file << " is empty\n";
+        close(fd);
+        return 1;
+    }
+
+    void *mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        std::cerr << "Could not mmap " << itch_file << "\n";
+        return 1;
+    }
+    madvise(mapped, file_stat.st_size, MADV_SEQUENTIAL);
+
+    // one mapping per book, declared first so they go last
+    std::vector<std::unique_ptr<BookArena> > arenas;
+    std::vector<std::unique_ptr<OrderBook> > books;
+    std::vector<std::unique_ptr<OrderBookManager> > managers;
+    ItchDecoder decoder;
+    for (int i = 3; i < argc; i++)
+    {
+        const int stock_locate = atoi(argv[i]);
+        if (stock_locate <= 0 || stock_locate > UINT16_MAX)
+        {
+            std::cerr << "Invalid stock locate " << argv[i] << "\n";
+            munmap(mapped, file_stat.st_size);
+            return 1;
+        }
+        arenas.emplace_back(new BookArena(OrderBookManager::GetMemorySize()));
+        ScopedBookMemoryResource book_memory(arenas.back().get());
+        books.emplace_back(new OrderBook(std::string("LOCATE_") + argv[i], min_price_increment));
+        managers.emplace_back(new OrderBookManager(*books.back()));
+        decoder.SetSymbol((uint16_t)stock_locate, *managers.back(), min_price_increment);
+    }
+
+    const uint8_t *data = static_cast<const uint8_t *>(mapped);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const size_t num_bytes_decoded = decoder.Decode(data, file_stat.st_size);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double wall_time = std::chrono::duration<double>(end - start).count();
+
+    const ItchDecoderStats &stats = decoder.GetStats();
+    for (size_t i = 0; i < managers.size(); i++)
+    {
+        std::cout << managers[i]->ShowMarket();
+    }
+    std::cout << "Messages        : " << stats.num_messages << "\n";
+    std::cout << "Wall time (s)   : " << wall_time << "\n";
+    std::cout << "Messages/sec    : " << (wall_time > 0.0 ? stats.num_messages / wall_time : 0.0) << "\n";
+    std::cout << "Dispatched      : " << stats.num_dispatched << "\n";
+    std::cout << "Skipped         : " << stats.num_skipped << "\n";
+    std::cout << "Other symbols   : " << stats.num_unknown_symbols << "\n";
+    std::cout << "Unknown orders  : " << stats.num_unknown_orders << "\n";
+    std::cout << "Ignored         : " << stats.num_ignored << "\n";
+    std::cout << "Bad prices      : " << stats.num_bad_prices << "\n";
+    std::cout << "Malformed       : " << stats.num_malformed << "\n";
+    if (num_bytes_decoded != (size_t)file_stat.st_size)
+    {
+        std::cout << "Trailing bytes  : " << file_stat.st_size - num_bytes_decoded << " (cut off message)\n";
+    }
+
+    munmap(mapped, file_stat.st_size);
+    return 0;
+}
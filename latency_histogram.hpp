@@ -0,0 +1,157 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// Each power of two range is split into 2^LATENCY_SUB_BUCKET_BITS linear buckets,
+// which keeps the relative error of any reported percentile below ~3%
+#define LATENCY_SUB_BUCKET_BITS 5
+#define LATENCY_SUB_BUCKET_COUNT (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_BUCKET_COUNT ((64 - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKET_COUNT)
+
+/*
+ * Log-linear histogram of latency samples (nanoseconds, cycles, whatever the caller
+ * records). Memory is fixed at construction and Record() is a handful of integer
+ * ops, so it can sit on the hot path.
+ *
+ * One thread records, any thread may read at the same time (e.g. a dump while the book
+ * is fed). Every field is a relaxed atomic, written with a plain load and store since
+ * there is a single writer, so this costs no locked instruction. A reader sees every
+ * field whole, but fields may be a sample or so apart from each other.
+ */
+struct LatencyHistogram
+{
+    std::atomic<uint64_t> counts_[LATENCY_BUCKET_COUNT];
+    std::atomic<uint64_t> total_count_;
+    std::atomic<uint64_t> max_value_;
+    std::atomic<uint64_t> sum_;
+
+    LatencyHistogram() { Reset(); }
+
+    LatencyHistogram(const LatencyHistogram &other)
+    {
+        Reset();
+        Merge(other);
+    }
+
+    // a copy of what @other holds now, from the thread recording into this one
+    LatencyHistogram &operator=(const LatencyHistogram &other)
+    {
+        if (this != &other)
+        {
+            Reset();
+            Merge(other);
+        }
+        return *this;
+    }
+
+    // from the recording thread
+    void Reset()
+    {
+        for (unsigned int bucket = 0; bucket < LATENCY_BUCKET_COUNT; bucket++)
+        {
+            counts_[bucket].store(0, std::memory_order_relaxed);
+        }
+        total_count_.store(0, std::memory_order_relaxed);
+        max_value_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+    }
+
+    // single writer, so a relaxed add that isn't a read-modify-write
+    static void Add(std::atomic<uint64_t> &t_field_, uint64_t t_value_)
+    {
+        t_field_.store(t_field_.load(std::memory_order_relaxed) + t_value_, std::memory_order_relaxed);
+    }
+
+    static unsigned int GetBucket(uint64_t value)
+    {
+        if (value < LATENCY_SUB_BUCKET_COUNT)
+        {
+            return (unsigned int)value;
+        }
+        unsigned int exponent = 63 - __builtin_clzll(value);
+        unsigned int shift = exponent - LATENCY_SUB_BUCKET_BITS;
+        // top bit is implied, the next LATENCY_SUB_BUCKET_BITS bits pick the linear bucket
+        return ((shift + 1) << LATENCY_SUB_BUCKET_BITS) + (unsigned int)((value >> shift) & (LATENCY_SUB_BUCKET_COUNT - 1));
+    }
+
+    // highest value that falls into @bucket
+    static uint64_t GetBucketLimit(unsigned int bucket)
+    {
+        if (bucket < LATENCY_SUB_BUCKET_COUNT)
+        {
+            return bucket;
+        }
+        unsigned int shift = (bucket >> LATENCY_SUB_BUCKET_BITS) - 1;
+        uint64_t sub_bucket = bucket & (LATENCY_SUB_BUCKET_COUNT - 1);
+        uint64_t low = (LATENCY_SUB_BUCKET_COUNT + sub_bucket) << shift;
+        return low + ((uint64_t(1) << shift) - 1);
+    }
+
+    void Record(uint64_t value)
+    {
+        Add(counts_[GetBucket(value)], 1);
+        Add(total_count_, 1);
+        Add(sum_, value);
+        if (value > max_value_.load(std::memory_order_relaxed))
+        {
+            max_value_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // from the recording thread, @other may be recorded into meanwhile
+    void Merge(const LatencyHistogram &other)
+    {
+        for (unsigned int bucket = 0; bucket < LATENCY_BUCKET_COUNT; bucket++)
+        {
+            Add(counts_[bucket], other.counts_[bucket].load(std::memory_order_relaxed));
+        }
+        Add(total_count_, other.total_count_.load(std::memory_order_relaxed));
+        Add(sum_, other.sum_.load(std::memory_order_relaxed));
+        const uint64_t other_max_value = other.max_value_.load(std::memory_order_relaxed);
+        if (other_max_value > max_value_.load(std::memory_order_relaxed))
+        {
+            max_value_.store(other_max_value, std::memory_order_relaxed);
+        }
+    }
+
+    // @percentile in [0, 100], returns the upper limit of the bucket holding that rank
+    uint64_t GetPercentile(double percentile) const
+    {
+        const uint64_t total_count = GetCount();
+        const uint64_t max_value = GetMax();
+        if (total_count == 0)
+        {
+            return 0;
+        }
+        uint64_t rank = (uint64_t)(percentile / 100.0 * total_count);
+        if (rank >= total_count)
+        {
+            rank = total_count - 1;
+        }
+        uint64_t seen = 0;
+        for (unsigned int bucket = 0; bucket < LATENCY_BUCKET_COUNT; bucket++)
+        {
+            seen += counts_[bucket].load(std::memory_order_relaxed);
+            if (seen > rank)
+            {
+                uint64_t limit = GetBucketLimit(bucket);
+                return (limit < max_value ? limit : max_value);
+            }
+        }
+        return max_value;
+    }
+
+    uint64_t GetCount() const { return total_count_.load(std::memory_order_relaxed); }
+
+    uint64_t GetMax() const { return max_value_.load(std::memory_order_relaxed); }
+
+    double GetMean() const
+    {
+        const uint64_t total_count = GetCount();
+        return (total_count != 0 ? (double)sum_.load(std::memory_order_relaxed) / total_count : 0.0);
+    }
+};
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef LEVEL_BITMAP_HPP
+#define LEVEL_BITMAP_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "book_memory.hpp"
+
+/*
+ * Two level occupancy bitmap of the price levels of one side of the book.
+ * Bit i of words_ is set when level i is non-empty, and bit w of summary_ is set
+ * when words_[w] has any bit set. Finding the closest non-empty level below some
+ * index takes a count-leading-zeros on at most one word and one summary word (for
+ * ladders of up to 4096 levels), however many empty levels are in between, and the
+ * number of non-empty levels in a range is a popcount per 64 levels.
+ */
+class LevelBitmap
+{
+  private:
+    BookVector<uint64_t> words_;
+    BookVector<uint64_t> summary_;
+
+    static int HighestBit(uint64_t t_word_) { return 63 - __builtin_clzll(t_word_); }
+
+    // bits strictly below @t_bit_ (0..63)
+    static uint64_t LowMask(int t_bit_) { return (uint64_t(1) << t_bit_) - 1; }
+
+    // highest non-empty word strictly below @t_word_, -1 if none
+    int FindPrevWord(int t_word_) const
+    {
+        int summary_index = t_word_ >> 6;
+        uint64_t summary_word = 0;
+        if (summary_index < (int)summary_.size())
+        {
+            summary_word = summary_[summary_index] & LowMask(t_word_ & 63);
+        }
+        else
+        {
+            summary_index = (int)summary_.size();
+        }
+
+        while (summary_word == 0)
+        {
+            if (--summary_index < 0)
+            {
+                return -1;
+            }
+            summary_word = summary_[summary_index];
+        }
+        return (summary_index << 6) + HighestBit(summary_word);
+    }
+
+  public:
+    LevelBitmap() {}
+
+    void Resize(int t_num_levels_)
+    {
+        words_.assign((t_num_levels_ + 63) / 64, 0);
+        summary_.assign((words_.size() + 63) / 64, 0);
+    }
+
+    // what Resize(@t_num_levels_) takes from the BookMemoryResource
+    static size_t GetMemorySize(int t_num_levels_)
+    {
+        const size_t num_words = (t_num_levels_ + 63) / 64;
+        return GetBookAllocationSize(num_words * sizeof(uint64_t)) +
+               GetBookAllocationSize((num_words + 63) / 64 * sizeof(uint64_t));
+    }
+
+    void Clear()
+    {
+        words_.assign(words_.size(), 0);
+        summary_.assign(summary_.size(), 0);
+    }
+
+    bool Test(int t_index_) const { return (words_[t_index_ >> 6] >> (t_index_ & 63)) & 1; }
+
+    void Set(int t_index_)
+    {
+        int word = t_index_ >> 6;
+        words_[word] |= uint64_t(1) << (t_index_ & 63);
+        summary_[word >> 6] |= uint64_t(1) << (word & 63);
+    }
+
+    void Reset(int t_index_)
+    {
+        int word = t_index_ >> 6;
+        words_[word] &= ~(uint64_t(1) << (t_index_ & 63));
+        if (words_[word] == 0)
+        {
+            summary_[word >> 6] &= ~(uint64_t(1) << (word & 63));
+        }
+    }
+
+    // highest set index strictly below @t_index_, -1 if none
+    int FindPrev(int t_index_) const
+    {
+        if (t_index_ > (int)words_.size() * 64)
+        {
+            t_index_ = (int)words_.size() * 64;
+        }
+        if (t_index_ <= 0)
+        {
+            return -1;
+        }
+
+        int word = t_index_ >> 6;
+        if ((t_index_ & 63) != 0)
+        {
+            uint64_t bits = words_[word] & LowMask(t_index_ & 63);
+            if (bits != 0)
+            {
+                return (word << 6) + HighestBit(bits);
+            }
+        }
+
+        word = FindPrevWord(word);
+        return (word < 0 ? -1 : (word << 6) + HighestBit(words_[word]));
+    }
+
+    // number of set indices in [@t_low_index_, @t_high_index_)
+    int Count(int t_low_index_, int t_high_index_) const
+    {
+        if (t_low_index_ < 0)
+        {
+            t_low_index_ = 0;
+        }
+        if (t_high_index_ > (int)words_.size() * 64)
+        {
+            t_high_index_ = (int)words_.size() * 64;
+        }
+        if (t_low_index_ >= t_high_index_)
+        {
+            return 0;
+        }
+
+        int low_word = t_low_index_ >> 6;
+        int high_word = (t_high_index_ - 1) >> 6;
+        uint64_t low_mask = ~LowMask(t_low_index_ & 63);
+        uint64_t high_mask = ((t_high_index_ & 63) == 0 ? ~uint64_t(0) : LowMask(t_high_index_ & 63));
+
+        if (low_word == high_word)
+        {
+            return __builtin_popcountll(words_[low_word] & low_mask & high_mask);
+        }
+
+        int count = __builtin_popcountll(words_[low_word] & low_mask);
+        for (int word = low_word + 1; word < high_word; word++)
+        {
+            count += __builtin_popcountll(words_[word]);
+        }
+        return count + __builtin_popcountll(words_[high_word] & high_mask);
+    }
+};
+
+#endif
@@ -0,0 +1,128 @@
+#include "level_kernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LEVEL_KERNELS_X86 1
+#else
+#define LEVEL_KERNELS_X86 0
+#endif
+
+static void SumLevelSizesScalar(const int *t_sizes_, int t_count_, LevelSums &t_sums_)
+{
+    int64_t size_sum = 0;
+    int64_t weighted_sum = 0;
+    for (int index = 0; index < t_count_; index++)
+    {
+        size_sum += t_sizes_[index];
+        weighted_sum += (int64_t)index * t_sizes_[index];
+    }
+    t_sums_.size_sum_ += size_sum;
+    t_sums_.weighted_sum_ += weighted_sum;
+}
+
+#if LEVEL_KERNELS_X86
+
+__attribute__((target("sse4.1"))) static void SumLevelSizesSSE41(const int *t_sizes_, int t_count_,
+                                                                  LevelSums &t_sums_)
+{
+    // two 64 bit lanes per accumulator: sizes are widened before adding so nothing overflows
+    __m128i size_acc = _mm_setzero_si128();
+    __m128i weight_acc = _mm_setzero_si128();
+    __m128i index_lo = _mm_set_epi64x(1, 0);
+    __m128i index_hi = _mm_set_epi64x(3, 2);
+    const __m128i step = _mm_set1_epi64x(4);
+
+    int index = 0;
+    for (; index + 4 <= t_count_; index += 4)
+    {
+        __m128i sizes = _mm_loadu_si128((const __m128i *)(t_sizes_ + index));
+        __m128i sizes_lo = _mm_cvtepi32_epi64(sizes);
+        __m128i sizes_hi = _mm_cvtepi32_epi64(_mm_srli_si128(sizes, 8));
+
+        size_acc = _mm_add_epi64(size_acc, _mm_add_epi64(sizes_lo, sizes_hi));
+        weight_acc = _mm_add_epi64(weight_acc, _mm_mul_epi32(sizes_lo, index_lo));
+        weight_acc = _mm_add_epi64(weight_acc, _mm_mul_epi32(sizes_hi, index_hi));
+
+        index_lo = _mm_add_epi64(index_lo, step);
+        index_hi = _mm_add_epi64(index_hi, step);
+    }
+
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, size_acc);
+    int64_t size_sum = lanes[0] + lanes[1];
+    _mm_storeu_si128((__m128i *)lanes, weight_acc);
+    int64_t weighted_sum = lanes[0] + lanes[1];
+
+    for (; index < t_count_; index++)
+    {
+        size_sum += t_sizes_[index];
+        weighted_sum += (int64_t)index * t_sizes_[index];
+    }
+    t_sums_.size_sum_ += size_sum;
+    t_sums_.weighted_sum_ += weighted_sum;
+}
+
+__attribute__((target("avx2"))) static void SumLevelSizesAVX2(const int *t_sizes_, int t_count_, LevelSums &t_sums_)
+{
+    __m256i size_acc = _mm256_setzero_si256();
+    __m256i weight_acc = _mm256_setzero_si256();
+    __m256i index_lo = _mm256_set_epi64x(3, 2, 1, 0);
+    __m256i index_hi = _mm256_set_epi64x(7, 6, 5, 4);
+    const __m256i step = _mm256_set1_epi64x(8);
+
+    int index = 0;
+    for (; index + 8 <= t_count_; index += 8)
+    {
+        __m256i sizes = _mm256_loadu_si256((const __m256i *)(t_sizes_ + index));
+        __m256i sizes_lo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(sizes));
+        __m256i sizes_hi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(sizes, 1));
+
+        size_acc = _mm256_add_epi64(size_acc, _mm256_add_epi64(sizes_lo, sizes_hi));
+        weight_acc = _mm256_add_epi64(weight_acc, _mm256_mul_epi32(sizes_lo, index_lo));
+        weight_acc = _mm256_add_epi64(weight_acc, _mm256_mul_epi32(sizes_hi, index_hi));
+
+        index_lo = _mm256_add_epi64(index_lo, step);
+        index_hi = _mm256_add_epi64(index_hi, step);
+    }
+
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, size_acc);
+    int64_t size_sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_storeu_si256((__m256i *)lanes, weight_acc);
+    int64_t weighted_sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    for (; index < t_count_; index++)
+    {
+        size_sum += t_sizes_[index];
+        weighted_sum += (int64_t)index * t_sizes_[index];
+    }
+    t_sums_.size_sum_ += size_sum;
+    t_sums_.weighted_sum_ += weighted_sum;
+}
+
+#endif
+
+typedef void (*SumLevelSizesFunc)(const int *, int, LevelSums &);
+
+static SumLevelSizesFunc ResolveSumLevelSizes()
+{
+#if LEVEL_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SumLevelSizesAVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+        return SumLevelSizesSSE41;
+    }
+#endif
+    return SumLevelSizesScalar;
+}
+
+static const SumLevelSizesFunc sum_level_sizes_func = ResolveSumLevelSizes();
+
+void SumLevelSizes(const int *t_sizes_, int t_count_, LevelSums &t_sums_)
+{
+    sum_level_sizes_func(t_sizes_, t_count_, t_sums_);
+}
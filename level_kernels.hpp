@@ -0,0 +1,24 @@
+#ifndef LEVEL_KERNELS_HPP
+#define LEVEL_KERNELS_HPP
+
+#include <cstdint>
+
+// Result of one pass over a contiguous run of level sizes
+struct LevelSums
+{
+    int64_t size_sum_;     // sum of sizes[i]
+    int64_t weighted_sum_; // sum of i * sizes[i], i counted from the start of the run
+
+    LevelSums() : size_sum_(0), weighted_sum_(0) {}
+};
+
+/*
+ * Accumulates the sums of @t_count_ consecutive level sizes into @t_sums_, in a single
+ * vectorized pass. With the level price implied by the position in the run, the size
+ * sum gives the depth over a price range and the weighted sum the size weighted
+ * average distance, i.e. the VWAP. Uses AVX2 or SSE4.1 when the cpu has them, a scalar
+ * loop otherwise; all three give the exact same (integer) result.
+ */
+void SumLevelSizes(const int *t_sizes_, int t_count_, LevelSums &t_sums_);
+
+#endif
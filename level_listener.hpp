@@ -0,0 +1,44 @@
+#ifndef LEVEL_LISTENER_HPP
+#define LEVEL_LISTENER_HPP
+
+#include <cstdint>
+
+// LevelUpdate actions
+#define LEVEL_ACTION_NEW 'N'    // the level was empty before this event
+#define LEVEL_ACTION_CHANGE 'C' // size and/or order count of a non-empty level changed
+#define LEVEL_ACTION_DELETE 'D' // the level is empty after this event
+
+// One L2 price level change, as produced by a single order event
+struct LevelUpdate
+{
+    uint8_t side;   // 'B' or 'S'
+    uint8_t action; // LEVEL_ACTION_*
+    int int_price;  // price of the level in ticks
+    int size;       // size at the level after the event, 0 on delete
+    int ordercount; // number of orders at the level after the event, 0 on delete
+    int level;      // number of non-empty levels ahead of this one, 0 is the best level
+};
+
+// One trade of an incoming order against a resting one, matching mode only
+struct Fill
+{
+    uint64_t aggressor_order_id;
+    uint64_t resting_order_id;
+    uint8_t aggressor_side; // 'B' or 'S', the resting order is on the other side
+    int int_price;          // price of the resting order in ticks
+    int size;
+    int resting_size_left;  // size the resting order still has, 0 if it is gone
+};
+
+/*
+ * Default listener of BasicOrderBookManager. A listener is any class with
+ * OnLevelUpdate(const LevelUpdate &) and OnFill(const Fill &) members; the manager calls
+ * them inline, so with this one the calls compile away entirely.
+ */
+struct NullLevelListener
+{
+    void OnLevelUpdate(const LevelUpdate &) {}
+    void OnFill(const Fill &) {}
+};
+
+#endif
@@ -1,19 +1,15 @@
+#ifndef ORDER_BOOK_HPP
+#define ORDER_BOOK_HPP
+
+#include <math.h>
 #include <vector>
 #include <deque>
 #include <string>
 #include <cstdint>
 #include <typeinfo>
 
-#define LOW_ACCESS_INDEX 50
-#define DEBUG_MODE_ON 0
-
-struct PriceLevelInfo
-{
-    int limit_int_price_;  // integer value of the price, computed by dividing by min price increment.
-    double limit_price_;   // price at this level
-    int limit_size_;       // cumulative size at this level
-    int limit_ordercount_; // cumulative count of orders at this level
-};
+#include "book_snapshot.hpp"
+#include "side_book.hpp"
 
 struct OrderBook
 {
@@ -21,78 +17,158 @@ struct OrderBook
 
     std::string exchange_symbol_;
 
-    std::vector<PriceLevelInfo> bid_levels_;
-    std::vector<PriceLevelInfo> ask_levels_;
+    // one ladder per side, see side_book.hpp. Code that already knows the side at compile time
+    // goes through GetSideBook<S>(), the GetBid*/GetAsk* functions below forward to them.
+    SideBook<BID_SIDE> bid_book_;
+    SideBook<ASK_SIDE> ask_book_;
 
     bool is_ready_;
     bool initial_book_constructed_;
 
-    unsigned int base_bid_index_;
-    unsigned int base_ask_index_;
-
     unsigned int initial_tick_size_;
     unsigned int max_tick_range_;
 
+#if LATENCY_PROBES_ON
+    // latency of the handlers feeding this book and its rare paths, see book_probes.hpp
+    BookProbes probes_;
+
+    const BookProbes &GetProbes() const { return probes_; }
+#endif
+
     // functions
     OrderBook(std::string t_exchange_symbol_, double min_price_increment);
 
     ~OrderBook(){};
 
-    void ResetBidLevel(int index);
-    void ResetAskLevel(int index);
+    template <Side S>
+    SideBook<S> &GetSideBook();
+
+    void ResetBidLevel(int index) { bid_book_.ResetLevel(index); }
+    void ResetAskLevel(int index) { ask_book_.ResetLevel(index); }
 
     void BuildIndex(char t_buysell_, int int_price_);
 
+    // lays out both sides around their own best prices, e.g. from a snapshot with both sides known
+    void BuildIndex(int t_int_bid_price_, int t_int_ask_price_);
+
     void Initialize();
 
+    // what the ladders of both sides take from the BookMemoryResource, see BookArena
+    static size_t GetMemorySize();
+
     void ResetBook();
 
+    // fills @snapshot with the top @num_levels (at most BOOK_SNAPSHOT_MAX_LEVELS) non-empty levels per side
+    void GetSnapshot(BookSnapshot &snapshot, int num_levels);
+
+    // formats GetSnapshot of the top 10 levels
     std::string ShowMarket();
 
-    bool IsBidLevelEmpty(int bid_index);
-    bool IsAskLevelEmpty(int ask_index);
+    // the ShowMarket table of any snapshot, e.g. one read back from shared memory
+    static std::string FormatSnapshot(const std::string &t_exchange_symbol_, const BookSnapshot &snapshot);
+
+    bool IsBidLevelEmpty(int bid_index) { return bid_book_.IsLevelEmpty(bid_index); }
+    bool IsAskLevelEmpty(int ask_index) { return ask_book_.IsLevelEmpty(ask_index); }
+
+    bool IsAskBookEmpty() { return ask_book_.IsBookEmpty(); }
+    bool IsBidBookEmpty() { return bid_book_.IsBookEmpty(); }
+
+    void UpdateBidLevel(int index, int size, int ordercount) { bid_book_.UpdateLevel(index, size, ordercount); }
+    void UpdateAskLevel(int index, int size, int ordercount) { ask_book_.UpdateLevel(index, size, ordercount); }
 
-    bool IsAskBookEmpty();
-    bool IsBidBookEmpty();
+    void AppendBidOrder(int index, OrderNode *node) { bid_book_.AppendOrder(index, node); }
+    void AppendAskOrder(int index, OrderNode *node) { ask_book_.AppendOrder(index, node); }
 
-    void UpdateBidLevel(int index, int size, int ordercount);
-    void UpdateAskLevel(int index, int size, int ordercount);
+    void RemoveBidOrder(int index, OrderNode *node) { bid_book_.RemoveOrder(index, node); }
+    void RemoveAskOrder(int index, OrderNode *node) { ask_book_.RemoveOrder(index, node); }
+
+    // Market by price ingest, for venues that publish aggregated levels rather than orders: the level
+    // at @t_int_price_ is overwritten as a whole, straight in the ladder, no order map involved.
+    // Size or ordercount 0 deletes the level, a feed without order counts passes 1
+    void OnLevelUpdate(uint8_t t_side_, int t_int_price_, int t_size_, int t_ordercount_);
+    void OnLevelDelete(uint8_t t_side_, int t_int_price_);
 
     void RebuildIndexHighAccess(char t_buysell_, int new_int_price_);
     void RebuildIndexLowAccess(char t_buysell_, int new_int_price_);
 
+    // best level, or the level it was last at if the side is empty
+    unsigned int GetBaseBidIndex() const { return bid_book_.base_index_; }
+    unsigned int GetBaseAskIndex() const { return ask_book_.base_index_; }
+
+    // closest non-empty level worse than @index, -1 if there is none
+    int GetNextBidIndex(int index) { return bid_book_.GetNextIndex(index); }
+    int GetNextAskIndex(int index) { return ask_book_.GetNextIndex(index); }
+
+    // number of non-empty levels with index in [low_index, high_index)
+    int GetBidLevelCount(int low_index, int high_index) { return bid_book_.GetLevelCount(low_index, high_index); }
+    int GetAskLevelCount(int low_index, int high_index) { return ask_book_.GetLevelCount(low_index, high_index); }
+
+    // size sum and size weighted distance from high_index over the levels [low_index, high_index]
+    void SumBidLevels(int low_index, int high_index, LevelSums &sums) { bid_book_.SumLevels(low_index, high_index, sums); }
+    void SumAskLevels(int low_index, int high_index, LevelSums &sums) { ask_book_.SumLevels(low_index, high_index, sums); }
+
+    // size weighted average price of the top @num_levels non-empty levels, 0 if the side is empty
+    double GetBidVWAP(int num_levels) { return bid_book_.GetVWAP(num_levels, min_price_increment_); }
+    double GetAskVWAP(int num_levels) { return ask_book_.GetVWAP(num_levels, min_price_increment_); }
+
+    // total size at prices at least as good as @int_price, levels above the base index are empty
+    int64_t GetBidDepthToPrice(int int_price) { return bid_book_.GetDepthToPrice(int_price); }
+    int64_t GetAskDepthToPrice(int int_price) { return ask_book_.GetDepthToPrice(int_price); }
+
+    // total size within @num_ticks of the best price
+    int64_t GetBidSizeWithinTicks(int num_ticks) { return bid_book_.GetSizeWithinTicks(num_ticks); }
+    int64_t GetAskSizeWithinTicks(int num_ticks) { return ask_book_.GetSizeWithinTicks(num_ticks); }
+
+    int GetBidSlot(int index) const { return bid_book_.GetSlot(index); }
+
+    int GetAskSlot(int index) const { return ask_book_.GetSlot(index); }
+
     double min_price_increment() const
     {
         return min_price_increment_;
     }
 
-    int GetBidIndex(int int_price)
-    {
-        return base_bid_index_ - (bid_levels_[base_bid_index_].limit_int_price_ - int_price);
-    }
+    int GetBidIndex(int int_price) { return bid_book_.GetIndex(int_price); }
 
-    int GetAskIndex(int int_price)
-    {
-        return base_ask_index_ + (ask_levels_[base_ask_index_].limit_int_price_ - int_price);
-    }
+    int GetAskIndex(int int_price) { return ask_book_.GetIndex(int_price); }
+
+    int GetBidIntPrice(int index) { return bid_book_.GetIntPrice(index); }
 
-    int GetBidIntPrice(int index) { return (index >= 0 ? bid_levels_[index].limit_int_price_ : 0); }
+    int GetAskIntPrice(int index) { return ask_book_.GetIntPrice(index); }
 
-    int GetAskIntPrice(int index) { return (index >= 0 ? ask_levels_[index].limit_int_price_ : 0); }
+    int GetBidSize(int index) { return bid_book_.GetSize(index); }
 
-    int GetBidSize(int index) { return (index >= 0 ? bid_levels_[index].limit_size_ : 0); }
+    int GetAskSize(int index) { return ask_book_.GetSize(index); }
 
-    int GetAskSize(int index) { return (index >= 0 ? ask_levels_[index].limit_size_ : 0); }
+    double GetBidPrice(int index) { return (index >= 0 ? GetDoublePx(bid_book_.GetIntPrice(index)) : 0); }
 
-    double GetBidPrice(int index) { return (index >= 0 ? bid_levels_[index].limit_price_ : 0); }
+    double GetAskPrice(int index) { return (index >= 0 ? GetDoublePx(ask_book_.GetIntPrice(index)) : 0); }
 
-    double GetAskPrice(int index) { return (index >= 0 ? ask_levels_[index].limit_price_ : 0); }
+    int GetBidOrders(int index) { return bid_book_.GetOrders(index); }
 
-    int GetBidOrders(int index) { return (index >= 0 ? bid_levels_[index].limit_ordercount_ : 0); }
+    int GetAskOrders(int index) { return ask_book_.GetOrders(index); }
 
-    int GetAskOrders(int index) { return (index >= 0 ? ask_levels_[index].limit_ordercount_ : 0); }
+    // first order in time priority at the level (L3 mode only), follow next_ for the rest of the queue
+    const OrderNode *GetBidFrontOrder(int index) { return bid_book_.GetFrontOrder(index); }
+
+    const OrderNode *GetAskFrontOrder(int index) { return ask_book_.GetFrontOrder(index); }
 
     double GetDoublePx(const int t_int_price_) const { return min_price_increment_ * t_int_price_; }
 
-    int GetIntPx(const double &t_price_) const { return t_price_ / min_price_increment_; }
+    // rounds to the nearest tick, truncating would put e.g. 0.3 / 0.1 = 2.9999999999999996 one tick low
+    int GetIntPx(const double &t_price_) const { return (int)lround(t_price_ / min_price_increment_); }
 };
+
+template <>
+inline SideBook<BID_SIDE> &OrderBook::GetSideBook<BID_SIDE>()
+{
+    return bid_book_;
+}
+
+template <>
+inline SideBook<ASK_SIDE> &OrderBook::GetSideBook<ASK_SIDE>()
+{
+    return ask_book_;
+}
+
+#endif
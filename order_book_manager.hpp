@@ -1,41 +1,174 @@
+#ifndef ORDER_BOOK_MANAGER_HPP
+#define ORDER_BOOK_MANAGER_HPP
+
 #include <vector>
 #include <map>
-#include <unordered_map>
+#include <memory>
+#include "book_checkpoint.hpp"
+#include "book_log.hpp"
+#include "flat_hash_map.hpp"
+#include "level_listener.hpp"
 #include "order_book.hpp"
+#include "order_event.hpp"
+#include "seqlock.hpp"
+
+#define DEFAULT_MAX_LIVE_ORDERS (1 << 16)
+
+// ProcessBatch looks up the order of the event this many positions ahead and prefetches its
+// level, and prefetches the order map slot of the event twice as far ahead
+#define BATCH_PREFETCH_DISTANCE 8
 
 // Order struct
 struct OrderInfo
 {
-    double price;
+    int int_price; // price in ticks, so the level is found again without a division
     int size;
     uint8_t side;
+    OrderNode *node; // position in the level queue, L3 mode only
 
-    OrderInfo() : price(0.0), size(-1), side('-') {}
-    OrderInfo(double t_price, int t_size, uint8_t t_side)
+    OrderInfo() : int_price(0), size(-1), side('-'), node(nullptr) {}
+    OrderInfo(int t_int_price, int t_size, uint8_t t_side)
     {
-        price = t_price;
+        int_price = t_int_price;
         size = t_size;
         side = t_side;
+        node = nullptr;
     }
 };
 
+// An add collected between OnOrderResetBegin and OnOrderResetEnd
+struct BulkOrder
+{
+    uint64_t order_id;
+    int int_price;
+    int size;
+    uint8_t side;
+};
+
 // This is the class which manipulates the underlying order book upon
-// various events
-class OrderBookManager
+// various events. Every level change is reported to the LevelListener (see level_listener.hpp),
+// the definitions are in order_book_manager_impl.hpp.
+template <typename LevelListener>
+class BasicOrderBookManager
 {
   private:
-    std::unordered_map<uint64_t, OrderInfo>::iterator bid_order_info_map_iter_;
-    std::unordered_map<uint64_t, OrderInfo>::iterator ask_order_info_map_iter_;
-
-    // containers to hold all the live orders
-    std::unordered_map<uint64_t, OrderInfo> order_id_to_bid_order_info_map_;
-    std::unordered_map<uint64_t, OrderInfo> order_id_to_ask_order_info_map_;
+    // containers to hold all the live orders, sized once at construction
+    FlatHashMap<OrderInfo> order_id_to_bid_order_info_map_;
+    FlatHashMap<OrderInfo> order_id_to_ask_order_info_map_;
 
     // The underlying order book
     OrderBook &order_book_;
 
+    // In L3 mode every live order also has a node in the FIFO queue of its price level
+    bool l3_mode_;
+    OrderNodePool order_node_pool_;
+
+    // In matching mode an add that crosses the other side trades against it before it rests
+    bool matching_mode_;
+
+    LevelListener level_listener_;
+
+    // top of the book as seen by other threads, rewritten after every event at the best level
+    SeqLock<BestBidOffer> published_bbo_;
+    // top published_depth_ levels per side, rewritten after every event within them (0 = off).
+    // Points at owned_published_levels_ or at a slot owned by somebody else, e.g. in shared memory.
+    int published_depth_;
+    SeqLock<BookSnapshot> *published_levels_;
+    std::unique_ptr<SeqLock<BookSnapshot> > owned_published_levels_;
+
+    // Handlers never write to a stream themselves: an anomaly is counted and, if a channel is set,
+    // logged into it for an AsyncLogger thread to format (see book_log.hpp)
+    LogChannel *log_channel_;
+    uint64_t anomaly_counts_[NUM_BOOK_ANOMALIES];
+
+    // Between OnOrderResetBegin and OnOrderResetEnd adds are only collected here, the ladder is
+    // built from all of them at once when the refresh ends
+    bool is_bulk_loading_;
+    std::vector<BulkOrder> bulk_orders_;
+
+    void ReportAnomaly(BookAnomaly t_anomaly_, uint8_t t_side_, uint64_t t_order_id_, int64_t t_value_);
+
+    OrderNode *NewOrderNode(uint64_t t_order_id_, int t_size_);
+
+    template <Side S>
+    FlatHashMap<OrderInfo> &GetOrderInfoMap()
+    {
+        return (S == BID_SIDE ? order_id_to_bid_order_info_map_ : order_id_to_ask_order_info_map_);
+    }
+
+    template <Side S>
+    const FlatHashMap<OrderInfo> &GetOrderInfoMap() const
+    {
+        return (S == BID_SIDE ? order_id_to_bid_order_info_map_ : order_id_to_ask_order_info_map_);
+    }
+
+    // The handlers proper, one per side. The public handlers below switch on the side once and
+    // everything underneath works on a SideBook<S> with the side known at compile time.
+    // @t_order_info_ is the map slot of @t_order_id_ when the caller has already found it, nullptr
+    // has the handler look it up.
+    template <Side S>
+    void AddOrder(uint64_t t_order_id_, int t_int_price_, int t_size_);
+    template <Side S>
+    void DeleteOrder(uint64_t t_order_id_, OrderInfo *t_order_info_ = nullptr);
+    template <Side S>
+    void ModifyOrder(uint64_t t_order_id_, int t_new_size_, uint64_t t_new_order_id_,
+                     OrderInfo *t_order_info_ = nullptr);
+    template <Side S>
+    void ReplaceOrder(uint64_t t_order_id_, int t_new_int_price_, int t_new_size_, uint64_t t_new_order_id_,
+                      OrderInfo *t_order_info_ = nullptr);
+    template <Side S>
+    void ExecOrder(uint64_t t_order_id_, int t_size_exec_, OrderInfo *t_order_info_ = nullptr);
+
+    // market by price handlers proper
+    template <Side S>
+    void SetLevel(int t_int_price_, int t_size_, int t_ordercount_);
+    template <Side S>
+    void DeleteLevel(int t_int_price_);
+
+    // trades an incoming order of side S against the other side, returns the size left to rest
+    template <Side S>
+    int MatchOrder(uint64_t t_order_id_, int t_int_price_, int t_size_);
+
+    // the orders section of one side of a checkpoint, see book_checkpoint.hpp
+    template <Side S>
+    bool WriteCheckpointOrders(FILE *t_file_);
+    template <Side S>
+    bool RestoreCheckpointOrders(const BookCheckpointOrder *t_orders_, size_t t_num_orders_, bool t_has_queues_);
+    template <Side S>
+    bool WriteCheckpointOverflowLevels(FILE *t_file_);
+    template <Side S>
+    void RestoreCheckpointOverflowLevels(const BookCheckpointLevel *t_levels_, size_t t_num_levels_);
+
+    // second pass of OnOrderResetEnd, the ladder is already laid out around the best price
+    template <Side S>
+    void BulkLoadOrder(const BulkOrder &t_order_);
+
+    // reports every non-empty level of side S as new, best first
+    template <Side S>
+    void NotifyAllLevels();
+
+    // prefetch stages of ProcessBatch, they only read the book
+    template <Side S>
+    void PrefetchOrder(const OrderEvent &t_event_) const;
+    template <Side S>
+    void PrefetchLevel(const OrderEvent &t_event_);
+
+    // reports the level at @t_int_price_ on side S as it is now
+    template <Side S>
+    void NotifyLevel(uint8_t t_action_, int t_int_price_, int level);
+
+    // republishes what an event at @level (number of non-empty levels ahead of it) may have changed
+    void PublishTopOfBook(int level);
+
   public:
-    OrderBookManager(OrderBook &t_order_book);
+    // @t_max_live_orders_ is the number of live orders per side the order maps are sized for.
+    // @t_l3_mode_ keeps the full order-by-order queue of every level, not just the aggregates.
+    BasicOrderBookManager(OrderBook &t_order_book, size_t t_max_live_orders_ = DEFAULT_MAX_LIVE_ORDERS,
+                          bool t_l3_mode_ = false, const LevelListener &t_level_listener_ = LevelListener());
+
+    // what a manager built with these arguments takes from the BookMemoryResource, its OrderBook
+    // included: the capacity of a BookArena that holds the whole book
+    static size_t GetMemorySize(size_t t_max_live_orders_ = DEFAULT_MAX_LIVE_ORDERS, bool t_l3_mode_ = false);
 
     // Main Functions
     void OnOrderAdd(uint64_t t_order_id_, uint8_t t_side_, double t_price_, int t_size_);
@@ -44,11 +177,112 @@ class OrderBookManager
     void OnOrderReplace(uint64_t t_order_id_, uint8_t t_side_, double t_new_price_,
                         int t_new_size_, uint64_t t_new_order_id_);
     void OnOrderExec(uint64_t t_order_id_, uint8_t t_side_, double t_price_, int t_size_exec_);
+
+    // Same handlers with the price already in ticks (price / min_price_increment), for feeds that
+    // carry integer prices, see price_parser.hpp. The double versions above convert and forward here.
+    void OnOrderAddIntPx(uint64_t t_order_id_, uint8_t t_side_, int t_int_price_, int t_size_);
+    void OnOrderReplaceIntPx(uint64_t t_order_id_, uint8_t t_side_, int t_new_int_price_,
+                             int t_new_size_, uint64_t t_new_order_id_);
+    // the exec price isn't used, the size comes off the order at the price it rests at
+    void OnOrderExecIntPx(uint64_t t_order_id_, uint8_t t_side_, int t_int_price_, int t_size_exec_);
+
+    // Same handlers for an order the caller found with the non-const FindOrder, for feeds that carry
+    // no side: the side and the map slot are taken from @t_order_info_, so the order isn't looked up
+    // again. @t_order_info_ has to be what FindOrder(@t_order_id_) returned, with no other call in
+    // between. The order is resting, so an execution applies even with the other side empty. False
+    // if the event was ignored because the book isn't up yet.
+    bool OnOrderDelete(uint64_t t_order_id_, OrderInfo *t_order_info_);
+    bool OnOrderModify(uint64_t t_order_id_, OrderInfo *t_order_info_, int t_new_size_, uint64_t t_new_order_id_);
+    bool OnOrderReplaceIntPx(uint64_t t_order_id_, OrderInfo *t_order_info_, int t_new_int_price_, int t_new_size_,
+                             uint64_t t_new_order_id_);
+    bool OnOrderExecIntPx(uint64_t t_order_id_, OrderInfo *t_order_info_, int t_size_exec_);
+
+    // Market by price feeds: OrderBook::OnLevelUpdate/OnLevelDelete, plus the listener and the
+    // published top of book. A symbol is fed either orders or levels, not both, so a manager used
+    // only for levels can be built with @t_max_live_orders_ 0 and holds little beyond the ladder.
+    void OnLevelUpdate(uint8_t t_side_, int t_int_price_, int t_size_, int t_ordercount_);
+    void OnLevelDelete(uint8_t t_side_, int t_int_price_);
+
+    // dispatches one binary event record to the matching handler above
+    void OnEvent(const OrderEvent &t_event_);
+
+    // Same as calling OnEvent on each of the @t_num_events_ events in order, but the order map
+    // slots and ladder levels of the events a few positions ahead are prefetched while the
+    // current one is applied, so the cache misses of a burst overlap instead of queueing up
+    void ProcessBatch(const OrderEvent *t_events_, size_t t_num_events_);
+
+    // Start of a snapshot refresh: flushes the book, and from now on adds are only collected.
+    // OnOrderResetEnd builds the ladder from them in one pass, levels aggregated straight into
+    // their slots, without the level count or re-centring work of OnOrderAdd per order. Any other
+    // event ends the refresh first, as if OnOrderResetEnd had been called.
     void OnOrderResetBegin();
     void OnOrderResetEnd();
+    bool IsBulkLoading() const { return is_bulk_loading_; }
     void UpdateBaseBidIndex();
     void UpdateBaseAskIndex();
+    bool IsL3Mode() const { return l3_mode_; }
+
+    // Matching mode makes the manager the venue rather than a mirror of one: an add (or the add
+    // half of a replace) priced through the other side walks its levels best first and each level
+    // front to back, reporting every trade to the listener's OnFill, and only the remainder rests.
+    // Time priority comes from the level queues, so it needs L3 mode. Snapshot refreshes between
+    // OnOrderResetBegin/End are loaded as they are, without matching. False, and the mode left as it
+    // was, if matching is asked for outside L3 mode.
+    bool SetMatchingMode(bool t_matching_mode_);
+    bool IsMatchingMode() const { return matching_mode_; }
+    LevelListener &GetLevelListener() { return level_listener_; }
+
+    // Safe to read from any thread while this one processes events: Load/TryLoad give a
+    // consistent copy without ever blocking the feed.
+    const SeqLock<BestBidOffer> &GetPublishedBBO() const { return published_bbo_; }
+
+    // also publish the top @t_num_levels_ levels per side (at most BOOK_SNAPSHOT_MAX_LEVELS), set
+    // before events start flowing. nullptr until then.
+    void SetPublishedDepth(int t_num_levels_);
+    const SeqLock<BookSnapshot> *GetPublishedLevels() const { return published_levels_; }
+
+    // same, into @t_levels_ which has to outlive the manager (see ShmBookPublisher in shm_book.hpp)
+    void PublishLevelsTo(SeqLock<BookSnapshot> &t_levels_, int t_num_levels_);
+
+    // from AsyncLogger::NewChannel, nullptr to only count anomalies (the default)
+    void SetLogChannel(LogChannel *t_log_channel_) { log_channel_ = t_log_channel_; }
+
+    // number of times @t_anomaly_ happened since construction
+    uint64_t GetAnomalyCount(BookAnomaly t_anomaly_) const { return anomaly_counts_[t_anomaly_]; }
+
+    // Writes both ladders, the best indices and all live orders to @t_file_name_ (book_checkpoint.hpp).
+    // Call it between events, on the thread that feeds the manager. On failure @t_status_, if given,
+    // says why (GetBookCheckpointStatusText), nothing is printed.
+    bool SaveCheckpoint(const std::string &t_file_name_, BookCheckpointStatus *t_status_ = nullptr);
+
+    // Replaces the whole state with a checkpoint of the same symbol, tick size and window size.
+    // Levels are copied in and orders inserted straight into the maps, no handler runs, so the
+    // listener sees nothing; the published top of book is refreshed. False with the book untouched
+    // if the file doesn't fit this manager, false with the book flushed if its orders can't be stored.
+    // @t_status_ as for SaveCheckpoint.
+    bool LoadCheckpoint(const std::string &t_file_name_, BookCheckpointStatus *t_status_ = nullptr);
+
+    // queue node of a live order (L3 mode only), nullptr if the order isn't known
+    const OrderNode *GetOrderNode(uint64_t t_order_id_, uint8_t t_side_);
+
+    // a live order of either side, for feeds whose cancels and executions carry no side (side is in
+    // OrderInfo::side). nullptr if the order isn't known
+    const OrderInfo *FindOrder(uint64_t t_order_id_) const;
+
+    // the same for a feed handler that goes on to pass the order to the handlers taking an OrderInfo.
+    // A refresh in progress is ended first, as by any event but an add, so its orders are found.
+    OrderInfo *FindOrder(uint64_t t_order_id_);
+
     std::string ShowMarket() {
         return order_book_.ShowMarket();
     }
+
+    void GetSnapshot(BookSnapshot &t_snapshot_, int t_num_levels_) { order_book_.GetSnapshot(t_snapshot_, t_num_levels_); }
 };
+
+// The manager without a listener, compiled once in order_book_manager.cpp. To use a listener include
+// order_book_manager_impl.hpp and use BasicOrderBookManager<YourListener>.
+typedef BasicOrderBookManager<NullLevelListener> OrderBookManager;
+extern template class BasicOrderBookManager<NullLevelListener>;
+
+#endif
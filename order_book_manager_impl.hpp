@@ -0,0 +1,1508 @@
+#ifndef ORDER_BOOK_MANAGER_IMPL_HPP
+#define ORDER_BOOK_MANAGER_IMPL_HPP
+
+#include "order_book_manager.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+
+template <typename LevelListener>
+BasicOrderBookManager<LevelListener>::BasicOrderBookManager(OrderBook &t_order_book, size_t t_max_live_orders_,
+                                                            bool t_l3_mode_,
+                                                            const LevelListener &t_level_listener_)
+    : order_book_(t_order_book),
+      order_id_to_bid_order_info_map_(t_max_live_orders_),
+      order_id_to_ask_order_info_map_(t_max_live_orders_),
+      l3_mode_(t_l3_mode_),
+      order_node_pool_(t_l3_mode_ ? 2 * t_max_live_orders_ : 0),
+      matching_mode_(false),
+      level_listener_(t_level_listener_),
+      published_depth_(0),
+      published_levels_(nullptr),
+      log_channel_(nullptr),
+      is_bulk_loading_(false),
+      bulk_orders_()
+{
+    memset(anomaly_counts_, 0, sizeof(anomaly_counts_));
+}
+
+template <typename LevelListener>
+size_t BasicOrderBookManager<LevelListener>::GetMemorySize(size_t t_max_live_orders_, bool t_l3_mode_)
+{
+    return OrderBook::GetMemorySize() + 2 * FlatHashMap<OrderInfo>::GetMemorySize(t_max_live_orders_) +
+           OrderNodePool::GetMemorySize(t_l3_mode_ ? 2 * t_max_live_orders_ : 0);
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnOrderAdd(uint64_t t_order_id_, uint8_t t_side_, double t_price_,
+                                                      int t_size_)
+{
+    OnOrderAddIntPx(t_order_id_, t_side_, order_book_.GetIntPx(t_price_), t_size_);
+}
+
+/*
+* This function handles the case when a new order is added to the book
+*/
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnOrderAddIntPx(uint64_t t_order_id_, uint8_t t_side_, int t_int_price_,
+                                                           int t_size_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_ADD);
+
+#if DEBUG_MODE_ON
+    std::cout << typeid(*this).name() << ":" << __func__ << " " << t_order_id_ << " [" << t_int_price_ << "," << t_size_
+              << "," << t_side_ << "]" << std::endl;
+#endif
+
+    if (is_bulk_loading_)
+    {
+        if (t_side_ != 'B' && t_side_ != 'S')
+        {
+            ReportAnomaly(BOOK_ANOMALY_INVALID_SIDE, t_side_, t_order_id_, t_side_);
+            return;
+        }
+        BulkOrder bulk_order;
+        bulk_order.order_id = t_order_id_;
+        bulk_order.int_price = t_int_price_;
+        bulk_order.size = t_size_;
+        bulk_order.side = t_side_;
+        bulk_orders_.push_back(bulk_order);
+        return;
+    }
+
+    if (!order_book_.initial_book_constructed_)
+    {
+        order_book_.BuildIndex(t_side_, t_int_price_);
+    }
+
+    switch (t_side_)
+    {
+    case 'B':
+        AddOrder<BID_SIDE>(t_order_id_, t_int_price_, t_size_);
+        break;
+    case 'S':
+        AddOrder<ASK_SIDE>(t_order_id_, t_int_price_, t_size_);
+        break;
+    default:
+        ReportAnomaly(BOOK_ANOMALY_INVALID_SIDE, t_side_, t_order_id_, t_side_);
+        break;
+    }
+}
+
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::AddOrder(uint64_t t_order_id_, int t_int_price_, int t_size_)
+{
+    SideBook<S> &side_book = order_book_.GetSideBook<S>();
+    FlatHashMap<OrderInfo> &order_info_map = GetOrderInfoMap<S>();
+
+    BOOK_PROBE_START(lookup_start);
+    const bool is_duplicate = (order_info_map.Find(t_order_id_) != nullptr);
+    BOOK_PROBE_STOP(order_book_.probes_, BOOK_PROBE_ORDER_LOOKUP, lookup_start);
+    if (is_duplicate)
+    {
+        ReportAnomaly(BOOK_ANOMALY_DUPLICATE_ORDER, SideBook<S>::SIDE_CHAR, t_order_id_, t_int_price_);
+        return;
+    }
+
+    if (matching_mode_)
+    {
+        t_size_ = MatchOrder<S>(t_order_id_, t_int_price_, t_size_);
+        if (t_size_ <= 0)
+        {
+            return;
+        }
+    }
+
+    OrderInfo new_order(t_int_price_, t_size_, SideBook<S>::SIDE_CHAR);
+    BOOK_PROBE_START(insert_start);
+    OrderInfo *order_info = order_info_map.Insert(t_order_id_, new_order);
+    BOOK_PROBE_STOP(order_book_.probes_, BOOK_PROBE_ORDER_LOOKUP, insert_start);
+    if (order_info == nullptr)
+    {
+        ReportAnomaly(BOOK_ANOMALY_ORDER_MAP_FULL, SideBook<S>::SIDE_CHAR, t_order_id_, t_int_price_);
+        return;
+    }
+
+    BOOK_PROBE_START(ladder_start);
+    const int index = side_book.PrepareLevel(t_int_price_);
+    if (index < 0)
+    {
+        BOOK_PROBE_COUNT(order_book_.probes_, BOOK_PATH_OVERFLOW_ADD);
+    }
+
+    const bool is_new_level = side_book.IsLevelEmpty(index);
+    if (is_new_level)
+    {
+        side_book.UpdateLevel(index, t_size_, 1);
+    }
+    else
+    {
+        int cur_size_at_level = side_book.GetSize(index);
+        int cur_num_of_orders_at_level = side_book.GetOrders(index);
+        side_book.UpdateLevel(index, cur_size_at_level + t_size_, cur_num_of_orders_at_level + 1);
+    }
+
+    if (l3_mode_)
+    {
+        order_info->node = NewOrderNode(t_order_id_, t_size_);
+        if (order_info->node != nullptr)
+        {
+            side_book.AppendOrder(index, order_info->node);
+        }
+    }
+
+    side_book.base_index_ = std::max((int)side_book.base_index_, index);
+    BOOK_PROBE_STOP(order_book_.probes_, BOOK_PROBE_LADDER_UPDATE, ladder_start);
+
+    // find the level at which the new order is added, orders behind the window are in the overflow tier
+    const int new_order_level = side_book.GetLevelsAhead(index);
+    NotifyLevel<S>((is_new_level ? LEVEL_ACTION_NEW : LEVEL_ACTION_CHANGE), t_int_price_, new_order_level);
+
+    PublishTopOfBook(new_order_level);
+
+#if DEBUG_MODE_ON
+    std::cout << typeid(*this).name() << ":" << __func__ << "Order Added at level :" << new_order_level << "...."
+              << std::endl;
+#endif
+}
+
+/*
+ * Walks the other side from its best level while the level is at or through @t_int_price_.
+ * Orders are taken from the front of each level queue: filled ones leave the queue and the
+ * order map, a partially filled one keeps its place with the size left. The level is written
+ * back and reported once it is done with, not per fill. Nothing is allocated, the Fill passed
+ * to the listener lives on the stack
+ */
+template <typename LevelListener>
+template <Side S>
+int BasicOrderBookManager<LevelListener>::MatchOrder(uint64_t t_order_id_, int t_int_price_, int t_size_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_MATCH);
+
+    const Side O = SideBook<S>::OPPOSITE_SIDE;
+    SideBook<O> &resting_book = order_book_.GetSideBook<O>();
+    FlatHashMap<OrderInfo> &resting_order_map = GetOrderInfoMap<O>();
+
+    Fill fill;
+    fill.aggressor_order_id = t_order_id_;
+    fill.aggressor_side = SideBook<S>::SIDE_CHAR;
+
+    bool has_traded = false;
+    while (t_size_ > 0 && !resting_book.IsBookEmpty())
+    {
+        const int index = resting_book.base_index_;
+        const int level_int_price = resting_book.GetIntPrice(index);
+        if (SideBook<O>::IsBetter(t_int_price_, level_int_price))
+        {
+            break;
+        }
+
+        int level_size = resting_book.GetSize(index);
+        int level_ordercount = resting_book.GetOrders(index);
+        fill.int_price = level_int_price;
+
+        OrderNode *resting_node = resting_book.GetFrontOrder(index);
+        while (t_size_ > 0 && resting_node != nullptr)
+        {
+            OrderNode *next_node = resting_node->next_;
+            const int fill_size = std::min(t_size_, resting_node->size_);
+            t_size_ -= fill_size;
+            level_size -= fill_size;
+
+            fill.resting_order_id = resting_node->order_id_;
+            fill.size = fill_size;
+            fill.resting_size_left = resting_node->size_ - fill_size;
+
+            if (fill.resting_size_left == 0)
+            {
+                resting_book.RemoveOrder(index, resting_node);
+                resting_order_map.Erase(resting_node->order_id_);
+                order_node_pool_.Release(resting_node);
+                level_ordercount--;
+            }
+            else
+            {
+                resting_node->size_ = fill.resting_size_left;
+                OrderInfo *resting_order_info = resting_order_map.Find(resting_node->order_id_);
+                if (resting_order_info != nullptr)
+                {
+                    resting_order_info->size = fill.resting_size_left;
+                }
+            }
+            level_listener_.OnFill(fill);
+            has_traded = true;
+            resting_node = next_node;
+        }
+
+        resting_book.UpdateLevel(index, level_size, level_ordercount);
+        const bool is_level_deleted = resting_book.IsLevelEmpty(index);
+        if (is_level_deleted)
+        {
+            resting_book.UpdateBaseIndex();
+        }
+        NotifyLevel<O>((is_level_deleted ? LEVEL_ACTION_DELETE : LEVEL_ACTION_CHANGE), level_int_price, 0);
+
+        // orders kept out of the queue (node pool exhausted) can't be matched in time priority
+        if (!is_level_deleted)
+        {
+            break;
+        }
+    }
+
+    if (has_traded)
+    {
+        PublishTopOfBook(0);
+    }
+    return t_size_;
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnLevelUpdate(uint8_t t_side_, int t_int_price_, int t_size_,
+                                                         int t_ordercount_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_LEVEL_UPDATE);
+
+    if (is_bulk_loading_)
+    {
+        OnOrderResetEnd();
+    }
+
+    if (!order_book_.initial_book_constructed_)
+    {
+        order_book_.BuildIndex(t_side_, t_int_price_);
+    }
+
+    switch (t_side_)
+    {
+    case 'B':
+        SetLevel<BID_SIDE>(t_int_price_, t_size_, t_ordercount_);
+        break;
+    case 'S':
+        SetLevel<ASK_SIDE>(t_int_price_, t_size_, t_ordercount_);
+        break;
+    default:
+        ReportAnomaly(BOOK_ANOMALY_INVALID_SIDE, t_side_, 0, t_side_);
+        break;
+    }
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnLevelDelete(uint8_t t_side_, int t_int_price_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_LEVEL_DELETE);
+
+    if (is_bulk_loading_)
+    {
+        OnOrderResetEnd();
+    }
+
+    switch (t_side_)
+    {
+    case 'B':
+        DeleteLevel<BID_SIDE>(t_int_price_);
+        break;
+    case 'S':
+        DeleteLevel<ASK_SIDE>(t_int_price_);
+        break;
+    default:
+        ReportAnomaly(BOOK_ANOMALY_INVALID_SIDE, t_side_, 0, t_side_);
+        break;
+    }
+}
+
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::SetLevel(int t_int_price_, int t_size_, int t_ordercount_)
+{
+    if (t_size_ <= 0 || t_ordercount_ <= 0)
+    {
+        DeleteLevel<S>(t_int_price_);
+        return;
+    }
+
+    SideBook<S> &side_book = order_book_.GetSideBook<S>();
+    const bool is_new_level = side_book.SetLevel(t_int_price_, t_size_, t_ordercount_);
+
+    const int level = side_book.GetLevelsAhead(side_book.GetIndex(t_int_price_));
+    NotifyLevel<S>((is_new_level ? LEVEL_ACTION_NEW : LEVEL_ACTION_CHANGE), t_int_price_, level);
+    PublishTopOfBook(level);
+}
+
+/*
+ * The level number is counted after the fact: if the best level went, the window may have been
+ * re-centred, but nothing is better than the old best price, so it still comes out as 0
+ */
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::DeleteLevel(int t_int_price_)
+{
+    if (!order_book_.initial_book_constructed_)
+    {
+        BOOK_PROBE_COUNT(order_book_.probes_, BOOK_PATH_IGNORED_EVENT);
+        return;
+    }
+
+    SideBook<S> &side_book = order_book_.GetSideBook<S>();
+    if (!side_book.DeleteLevel(t_int_price_))
+    {
+        return;
+    }
+
+    const int level = side_book.GetLevelsAhead(side_book.GetIndex(t_int_price_));
+    NotifyLevel<S>(LEVEL_ACTION_DELETE, t_int_price_, level);
+    PublishTopOfBook(level);
+}
+
+template <typename LevelListener>
+bool BasicOrderBookManager<LevelListener>::SetMatchingMode(bool t_matching_mode_)
+{
+    if (t_matching_mode_ && !l3_mode_)
+    {
+        return false;
+    }
+    matching_mode_ = t_matching_mode_;
+    return true;
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnOrderDelete(uint64_t t_order_id_, uint8_t t_side_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_DELETE);
+
+#if DEBUG_MODE_ON
+    std::cout << typeid(*this).name() << ':' << __func__ << " " << t_order_id_;
+#endif
+
+    if (is_bulk_loading_)
+    {
+        OnOrderResetEnd();
+    }
+
+    switch (t_side_)
+    {
+    case 'B':
+        DeleteOrder<BID_SIDE>(t_order_id_);
+        break;
+    case 'S':
+        DeleteOrder<ASK_SIDE>(t_order_id_);
+        break;
+    default:
+        ReportAnomaly(BOOK_ANOMALY_INVALID_SIDE, t_side_, t_order_id_, t_side_);
+        break;
+    }
+}
+
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::DeleteOrder(uint64_t t_order_id_, OrderInfo *t_order_info_)
+{
+    if (!order_book_.initial_book_constructed_)
+    {
+        BOOK_PROBE_COUNT(order_book_.probes_, BOOK_PATH_IGNORED_EVENT);
+        return;
+    }
+
+    SideBook<S> &side_book = order_book_.GetSideBook<S>();
+    FlatHashMap<OrderInfo> &order_info_map = GetOrderInfoMap<S>();
+
+    // searching the order map to retrieve the meta-data corresponding to @t_order_id
+    BOOK_PROBE_START(lookup_start);
+    const OrderInfo *order_info = (t_order_info_ != nullptr ? t_order_info_ : order_info_map.Find(t_order_id_));
+    BOOK_PROBE_STOP(order_book_.probes_, BOOK_PROBE_ORDER_LOOKUP, lookup_start);
+    if (order_info == nullptr)
+    {
+        ReportAnomaly(BOOK_ANOMALY_UNKNOWN_DELETE, SideBook<S>::SIDE_CHAR, t_order_id_, 0);
+        return;
+    }
+    const int int_price = order_info->int_price;
+    const int order_size = order_info->size;
+    OrderNode *order_node = order_info->node;
+    order_info_map.Erase(t_order_id_);
+
+#if DEBUG_MODE_ON
+    std::cout << " [" << int_price << "," << order_size << "," << SideBook<S>::SIDE_CHAR << "]" << std::endl;
+#endif
+
+    // find the level to which this order belongs
+    BOOK_PROBE_START(ladder_start);
+    const int index = side_book.GetIndex(int_price);
+
+    if (order_node != nullptr)
+    {
+        side_book.RemoveOrder(index, order_node);
+        order_node_pool_.Release(order_node);
+    }
+
+    const bool is_order_present_in_best_level = (index == (int)side_book.base_index_);
+
+    // store the old information corresponding to the above found level @index
+    int cumulative_old_size = side_book.GetSize(index);
+    int cumulative_old_ordercount = side_book.GetOrders(index);
+
+    // modify the data at level @index
+    side_book.UpdateLevel(index, cumulative_old_size - order_size, cumulative_old_ordercount - 1);
+
+    // checking if no more orders are left at @index
+    const bool is_level_deleted = side_book.IsLevelEmpty(index);
+    BOOK_PROBE_STOP(order_book_.probes_, BOOK_PROBE_LADDER_UPDATE, ladder_start);
+
+#if DEBUG_MODE_ON
+    if (is_level_deleted)
+        std::cout << "Level Deleted...." << std::endl;
+#endif
+
+    // non-empty levels above the order, counted before the base index can move on
+    const int level_changed = side_book.GetLevelsAhead(index);
+
+    // checking if the level deleted is the best level
+    if (is_level_deleted && is_order_present_in_best_level)
+    {
+        side_book.UpdateBaseIndex();
+    }
+    NotifyLevel<S>((is_level_deleted ? LEVEL_ACTION_DELETE : LEVEL_ACTION_CHANGE), int_price, level_changed);
+
+    PublishTopOfBook(level_changed);
+
+#if DEBUG_MODE_ON
+    std::cout << typeid(*this).name() << ":" << __func__ << " Order Deleted at level :" << level_changed << "...."
+              << std::endl;
+#endif
+}
+
+/*
+ * This function assumes that the order to modify will only have its size changed
+ * but prices will remain same as before.The "Replace Order" where both prices and
+ * size can change has been implemented in OrderReplace as OrderDelete + OrderAdd
+ */
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnOrderModify(uint64_t t_order_id_, uint8_t t_side_, int t_new_size_,
+                                                         uint64_t t_new_order_id_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_MODIFY);
+
+#if DEBUG_MODE_ON
+    std::cout << typeid(*this).name() << ':' << __func__ << " " << t_order_id_;
+    std::cout << "[" << t_new_order_id_ << "," << t_new_size_ << "," << t_side_ << "]" << std::endl;
+#endif
+
+    if (is_bulk_loading_)
+    {
+        OnOrderResetEnd();
+    }
+
+    switch (t_side_)
+    {
+    case 'B':
+        ModifyOrder<BID_SIDE>(t_order_id_, t_new_size_, t_new_order_id_);
+        break;
+    case 'S':
+        ModifyOrder<ASK_SIDE>(t_order_id_, t_new_size_, t_new_order_id_);
+        break;
+    default:
+        ReportAnomaly(BOOK_ANOMALY_INVALID_SIDE, t_side_, t_order_id_, t_side_);
+        break;
+    }
+}
+
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::ModifyOrder(uint64_t t_order_id_, int t_new_size_, uint64_t t_new_order_id_,
+                                                       OrderInfo *t_order_info_)
+{
+    SideBook<S> &side_book = order_book_.GetSideBook<S>();
+    FlatHashMap<OrderInfo> &order_info_map = GetOrderInfoMap<S>();
+    int dropped_ordercount = 0;
+
+    BOOK_PROBE_START(lookup_start);
+    OrderInfo *order_info_ptr = (t_order_info_ != nullptr ? t_order_info_ : order_info_map.Find(t_order_id_));
+    BOOK_PROBE_STOP(order_book_.probes_, BOOK_PROBE_ORDER_LOOKUP, lookup_start);
+    if (order_info_ptr == nullptr)
+    {
+        ReportAnomaly(BOOK_ANOMALY_UNKNOWN_MODIFY, SideBook<S>::SIDE_CHAR, t_order_id_, t_new_size_);
+        return;
+    }
+
+    OrderInfo order_info = *order_info_ptr;
+    const int int_price = order_info.int_price;
+    const int old_order_size = order_info.size;
+    OrderNode *order_node = order_info.node;
+
+    // update the size
+    order_info.size = t_new_size_;
+
+    if (t_new_order_id_ == t_order_id_)
+    {
+        *order_info_ptr = order_info;
+    }
+    else
+    {
+        order_info_map.Erase(t_order_id_);
+        if (!order_info_map.Insert(t_new_order_id_, order_info))
+        {
+            ReportAnomaly(BOOK_ANOMALY_MODIFY_NOT_STORED, SideBook<S>::SIDE_CHAR, t_new_order_id_, t_new_size_);
+            t_new_size_ = 0;
+            dropped_ordercount = 1;
+        }
+    }
+
+    if (!order_book_.initial_book_constructed_)
+    {
+        order_book_.BuildIndex(SideBook<S>::SIDE_CHAR, int_price);
+    }
+
+    BOOK_PROBE_START(ladder_start);
+    const int index = side_book.GetIndex(int_price);
+    const bool is_order_present_in_best_level = (index == (int)side_book.base_index_);
+
+    if (order_node != nullptr)
+    {
+        if (dropped_ordercount != 0)
+        {
+            side_book.RemoveOrder(index, order_node);
+            order_node_pool_.Release(order_node);
+        }
+        else
+        {
+            order_node->order_id_ = t_new_order_id_;
+            order_node->size_ = t_new_size_;
+
+            // a new order id or a size increase loses time priority, a size decrease keeps it
+            if (t_new_order_id_ != t_order_id_ || t_new_size_ > old_order_size)
+            {
+                side_book.RemoveOrder(index, order_node);
+                side_book.AppendOrder(index, order_node);
+            }
+        }
+    }
+
+    // update the size at the corresponding level
+    const int cumulative_old_size = side_book.GetSize(index);
+    const int cumulative_old_ordercount = side_book.GetOrders(index);
+    side_book.UpdateLevel(index, cumulative_old_size - old_order_size + t_new_size_,
+                          cumulative_old_ordercount - dropped_ordercount);
+    BOOK_PROBE_STOP(order_book_.probes_, BOOK_PROBE_LADDER_UPDATE, ladder_start);
+
+    // check which level is modified, counted before the base index can move on
+    const int level_modified = side_book.GetLevelsAhead(index);
+    const bool is_level_deleted = side_book.IsLevelEmpty(index);
+
+    // an order dropped from the map (or modified to size 0) may have emptied the best level
+    if (is_level_deleted && is_order_present_in_best_level)
+    {
+        side_book.UpdateBaseIndex();
+    }
+    NotifyLevel<S>((is_level_deleted ? LEVEL_ACTION_DELETE : LEVEL_ACTION_CHANGE), int_price, level_modified);
+
+    PublishTopOfBook(level_modified);
+
+#if DEBUG_MODE_ON
+    std::cout << typeid(*this).name() << ":" << __func__ << "Order modified at level :" << level_modified << "...."
+              << std::endl;
+#endif
+}
+
+/*
+ * This is case where both price and size of an order can be changed. If the price of the order is same
+ * as before, just call the OrderModify ( which handles modify with same px ). If prices are different
+ * then simulate it with a Delete + Add ( if new_size > 0 )
+ */
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnOrderReplace(uint64_t t_order_id_, uint8_t t_side_, double t_new_price_,
+                                                          int t_new_size_, uint64_t t_new_order_id_)
+{
+    OnOrderReplaceIntPx(t_order_id_, t_side_, order_book_.GetIntPx(t_new_price_), t_new_size_, t_new_order_id_);
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnOrderReplaceIntPx(uint64_t t_order_id_, uint8_t t_side_,
+                                                               int t_new_int_price_, int t_new_size_,
+                                                               uint64_t t_new_order_id_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_REPLACE);
+
+#if DEBUG_MODE_ON
+    std::cout << typeid(*this).name() << ':' << __func__ << " " << t_order_id_ << std::endl;
+#endif
+
+    if (is_bulk_loading_)
+    {
+        OnOrderResetEnd();
+    }
+
+    switch (t_side_)
+    {
+    case 'B':
+        ReplaceOrder<BID_SIDE>(t_order_id_, t_new_int_price_, t_new_size_, t_new_order_id_);
+        break;
+    case 'S':
+        ReplaceOrder<ASK_SIDE>(t_order_id_, t_new_int_price_, t_new_size_, t_new_order_id_);
+        break;
+    default:
+        ReportAnomaly(BOOK_ANOMALY_INVALID_SIDE, t_side_, t_order_id_, t_side_);
+        break;
+    }
+}
+
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::ReplaceOrder(uint64_t t_order_id_, int t_new_int_price_, int t_new_size_,
+                                                        uint64_t t_new_order_id_, OrderInfo *t_order_info_)
+{
+    OrderInfo *order_info = (t_order_info_ != nullptr ? t_order_info_ : GetOrderInfoMap<S>().Find(t_order_id_));
+    if (order_info == nullptr)
+    {
+        ReportAnomaly(BOOK_ANOMALY_UNKNOWN_REPLACE, SideBook<S>::SIDE_CHAR, t_order_id_, t_new_int_price_);
+        return;
+    }
+
+    if (order_info->int_price == t_new_int_price_)
+    {
+        ModifyOrder<S>(t_order_id_, t_new_size_, t_new_order_id_, order_info);
+    }
+    else if (t_new_size_ > 0)
+    {
+        DeleteOrder<S>(t_order_id_, order_info);
+        if (!order_book_.initial_book_constructed_)
+        {
+            order_book_.BuildIndex(SideBook<S>::SIDE_CHAR, t_new_int_price_);
+        }
+        AddOrder<S>(t_new_order_id_, t_new_int_price_, t_new_size_);
+    }
+    else
+    {
+        DeleteOrder<S>(t_order_id_, order_info);
+    }
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnOrderExec(uint64_t t_order_id_, uint8_t t_side_, double t_price_,
+                                                       int t_size_exec_)
+{
+    OnOrderExecIntPx(t_order_id_, t_side_, order_book_.GetIntPx(t_price_), t_size_exec_);
+}
+
+/*
+ * This function assumes that the order exec received has been for a resting order,we
+ * simulate it as Delete ( if size is 0 ) or Modify ( if still has some size )
+ */
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnOrderExecIntPx(uint64_t t_order_id_, uint8_t t_side_, int /* t_int_price_ */,
+                                                            int t_size_exec_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_EXEC);
+
+#if DEBUG_MODE_ON
+    std::cout << typeid(*this).name() << ':' << __func__ << " " << t_order_id_ << std::endl;
+#endif
+
+    if (is_bulk_loading_)
+    {
+        OnOrderResetEnd();
+    }
+
+    // not till book is ready
+    if (!order_book_.initial_book_constructed_ || order_book_.IsBidBookEmpty() || order_book_.IsAskBookEmpty())
+    {
+        BOOK_PROBE_COUNT(order_book_.probes_, BOOK_PATH_IGNORED_EVENT);
+        return;
+    }
+
+    switch (t_side_)
+    {
+    case 'B':
+        ExecOrder<BID_SIDE>(t_order_id_, t_size_exec_);
+        break;
+    case 'S':
+        ExecOrder<ASK_SIDE>(t_order_id_, t_size_exec_);
+        break;
+    default:
+        ReportAnomaly(BOOK_ANOMALY_INVALID_SIDE, t_side_, t_order_id_, t_side_);
+        break;
+    }
+}
+
+/*
+ * The handlers above for an order already found with the non-const FindOrder, which has ended any
+ * refresh in progress, so there is no refresh to end here and the slot is handed straight down.
+ */
+template <typename LevelListener>
+bool BasicOrderBookManager<LevelListener>::OnOrderDelete(uint64_t t_order_id_, OrderInfo *t_order_info_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_DELETE);
+    if (!order_book_.initial_book_constructed_)
+    {
+        BOOK_PROBE_COUNT(order_book_.probes_, BOOK_PATH_IGNORED_EVENT);
+        return false;
+    }
+
+    if (t_order_info_->side == 'B')
+    {
+        DeleteOrder<BID_SIDE>(t_order_id_, t_order_info_);
+    }
+    else
+    {
+        DeleteOrder<ASK_SIDE>(t_order_id_, t_order_info_);
+    }
+    return true;
+}
+
+template <typename LevelListener>
+bool BasicOrderBookManager<LevelListener>::OnOrderModify(uint64_t t_order_id_, OrderInfo *t_order_info_,
+                                                         int t_new_size_, uint64_t t_new_order_id_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_MODIFY);
+    if (!order_book_.initial_book_constructed_)
+    {
+        BOOK_PROBE_COUNT(order_book_.probes_, BOOK_PATH_IGNORED_EVENT);
+        return false;
+    }
+
+    if (t_order_info_->side == 'B')
+    {
+        ModifyOrder<BID_SIDE>(t_order_id_, t_new_size_, t_new_order_id_, t_order_info_);
+    }
+    else
+    {
+        ModifyOrder<ASK_SIDE>(t_order_id_, t_new_size_, t_new_order_id_, t_order_info_);
+    }
+    return true;
+}
+
+template <typename LevelListener>
+bool BasicOrderBookManager<LevelListener>::OnOrderReplaceIntPx(uint64_t t_order_id_, OrderInfo *t_order_info_,
+                                                               int t_new_int_price_, int t_new_size_,
+                                                               uint64_t t_new_order_id_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_REPLACE);
+    if (!order_book_.initial_book_constructed_)
+    {
+        BOOK_PROBE_COUNT(order_book_.probes_, BOOK_PATH_IGNORED_EVENT);
+        return false;
+    }
+
+    if (t_order_info_->side == 'B')
+    {
+        ReplaceOrder<BID_SIDE>(t_order_id_, t_new_int_price_, t_new_size_, t_new_order_id_, t_order_info_);
+    }
+    else
+    {
+        ReplaceOrder<ASK_SIDE>(t_order_id_, t_new_int_price_, t_new_size_, t_new_order_id_, t_order_info_);
+    }
+    return true;
+}
+
+template <typename LevelListener>
+bool BasicOrderBookManager<LevelListener>::OnOrderExecIntPx(uint64_t t_order_id_, OrderInfo *t_order_info_,
+                                                            int t_size_exec_)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_EXEC);
+
+    // the order rests in the book, so only the book has to be up, not the other side
+    if (!order_book_.initial_book_constructed_)
+    {
+        BOOK_PROBE_COUNT(order_book_.probes_, BOOK_PATH_IGNORED_EVENT);
+        return false;
+    }
+
+    if (t_order_info_->side == 'B')
+    {
+        ExecOrder<BID_SIDE>(t_order_id_, t_size_exec_, t_order_info_);
+    }
+    else
+    {
+        ExecOrder<ASK_SIDE>(t_order_id_, t_size_exec_, t_order_info_);
+    }
+    return true;
+}
+
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::ExecOrder(uint64_t t_order_id_, int t_size_exec_, OrderInfo *t_order_info_)
+{
+    // Find the order_id_ in the map, if not preset its an error case, return
+    OrderInfo *order_info = (t_order_info_ != nullptr ? t_order_info_ : GetOrderInfoMap<S>().Find(t_order_id_));
+    if (order_info == nullptr)
+    {
+        ReportAnomaly(BOOK_ANOMALY_UNKNOWN_EXEC, SideBook<S>::SIDE_CHAR, t_order_id_, t_size_exec_);
+        return;
+    }
+
+    const int old_order_size = order_info->size;
+    int order_size_remained = old_order_size - t_size_exec_;
+#if DEBUG_MODE_ON
+    std::cout << "[" << old_order_size << "," << order_size_remained << "," << SideBook<S>::SIDE_CHAR << "]"
+              << std::endl;
+#endif
+
+    if (order_size_remained > 0)
+    {
+        ModifyOrder<S>(t_order_id_, order_size_remained, t_order_id_, order_info);
+    }
+    else
+    {
+        DeleteOrder<S>(t_order_id_, order_info);
+    }
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnOrderResetBegin()
+{
+    ReportAnomaly(BOOK_ANOMALY_BOOK_RESET, '-', 0, 0);
+    order_book_.Initialize();
+
+    // flushing all the orders
+    order_id_to_bid_order_info_map_.Clear();
+    order_id_to_ask_order_info_map_.Clear();
+    order_node_pool_.Reset();
+
+    // a refresh holds at most as many orders as the maps, only the first refresh allocates
+    is_bulk_loading_ = true;
+    bulk_orders_.clear();
+    bulk_orders_.reserve(order_id_to_bid_order_info_map_.capacity() + order_id_to_ask_order_info_map_.capacity());
+    PublishTopOfBook(0);
+}
+
+/*
+ * Builds the book from the orders collected since OnOrderResetBegin. The best price of each
+ * side is known up front, so the window is laid out once around it and every order goes straight
+ * into its level, in arrival order so L3 queues keep the order of the snapshot. Orders more
+ * than initial_tick_size_ ticks behind the best price go to the overflow tier. The listener
+ * then gets every level as new
+ */
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnOrderResetEnd()
+{
+    if (!is_bulk_loading_)
+    {
+        return;
+    }
+    is_bulk_loading_ = false;
+
+    bool has_bid = false;
+    bool has_ask = false;
+    int best_bid_int_price = 0;
+    int best_ask_int_price = 0;
+    for (size_t i = 0; i < bulk_orders_.size(); i++)
+    {
+        const BulkOrder &bulk_order = bulk_orders_[i];
+        if (bulk_order.side == 'B')
+        {
+            best_bid_int_price = (has_bid ? std::max(best_bid_int_price, bulk_order.int_price) : bulk_order.int_price);
+            has_bid = true;
+        }
+        else
+        {
+            best_ask_int_price = (has_ask ? std::min(best_ask_int_price, bulk_order.int_price) : bulk_order.int_price);
+            has_ask = true;
+        }
+    }
+
+    if (has_bid || has_ask)
+    {
+        order_book_.BuildIndex((has_bid ? best_bid_int_price : best_ask_int_price - 1),
+                               (has_ask ? best_ask_int_price : best_bid_int_price + 1));
+
+        for (size_t i = 0; i < bulk_orders_.size(); i++)
+        {
+            if (bulk_orders_[i].side == 'B')
+            {
+                BulkLoadOrder<BID_SIDE>(bulk_orders_[i]);
+            }
+            else
+            {
+                BulkLoadOrder<ASK_SIDE>(bulk_orders_[i]);
+            }
+        }
+
+        NotifyAllLevels<BID_SIDE>();
+        NotifyAllLevels<ASK_SIDE>();
+    }
+
+    bulk_orders_.clear();
+    PublishTopOfBook(0);
+}
+
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::BulkLoadOrder(const BulkOrder &t_order_)
+{
+    SideBook<S> &side_book = order_book_.GetSideBook<S>();
+    const int index = side_book.GetIndex(t_order_.int_price);
+
+    OrderInfo *order_info = GetOrderInfoMap<S>().Insert(
+        t_order_.order_id, OrderInfo(t_order_.int_price, t_order_.size, SideBook<S>::SIDE_CHAR));
+    if (order_info == nullptr)
+    {
+        const bool is_duplicate = (GetOrderInfoMap<S>().Find(t_order_.order_id) != nullptr);
+        ReportAnomaly((is_duplicate ? BOOK_ANOMALY_DUPLICATE_ORDER : BOOK_ANOMALY_ORDER_MAP_FULL),
+                      SideBook<S>::SIDE_CHAR, t_order_.order_id, t_order_.int_price);
+        return;
+    }
+
+    side_book.UpdateLevel(index, side_book.GetSize(index) + t_order_.size, side_book.GetOrders(index) + 1);
+
+    if (l3_mode_)
+    {
+        order_info->node = NewOrderNode(t_order_.order_id, t_order_.size);
+        if (order_info->node != nullptr)
+        {
+            side_book.AppendOrder(index, order_info->node);
+        }
+    }
+}
+
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::NotifyAllLevels()
+{
+    const SideBook<S> &side_book = order_book_.GetSideBook<S>();
+    int level = 0;
+    for (int index = side_book.GetBestIndex(); index >= 0; index = side_book.GetNextIndex(index))
+    {
+        NotifyLevel<S>(LEVEL_ACTION_NEW, side_book.GetIntPrice(index), level++);
+    }
+    for (size_t position = side_book.overflow_levels_.size(); position > 0; position--)
+    {
+        NotifyLevel<S>(LEVEL_ACTION_NEW, side_book.overflow_levels_[position - 1].int_price, level++);
+    }
+}
+
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::NotifyLevel(uint8_t t_action_, int t_int_price_, int level)
+{
+    LevelUpdate level_update;
+    level_update.side = SideBook<S>::SIDE_CHAR;
+    level_update.action = t_action_;
+    level_update.int_price = t_int_price_;
+    level_update.size = 0;
+    level_update.ordercount = 0;
+    level_update.level = level;
+
+    // the index is looked up again, the window may have been re-centred since the level was touched
+    if (t_action_ != LEVEL_ACTION_DELETE)
+    {
+        const SideBook<S> &side_book = order_book_.GetSideBook<S>();
+        const int index = side_book.GetIndex(t_int_price_);
+        level_update.size = side_book.GetSize(index);
+        level_update.ordercount = side_book.GetOrders(index);
+    }
+    level_listener_.OnLevelUpdate(level_update);
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::PublishTopOfBook(int level)
+{
+    BOOK_PROBE_SCOPE(order_book_.probes_, BOOK_PROBE_PUBLISH);
+
+    if (level < published_depth_)
+    {
+        BookSnapshot snapshot;
+        order_book_.GetSnapshot(snapshot, published_depth_);
+        published_levels_->Store(snapshot);
+    }
+
+    // only an event at the best level of a side (level 0) can change the touch
+    if (level != 0)
+    {
+        return;
+    }
+
+    BestBidOffer bbo;
+    memset(&bbo, 0, sizeof(bbo));
+    const int bid_index = order_book_.GetBaseBidIndex();
+    if (order_book_.initial_book_constructed_ && !order_book_.IsBidLevelEmpty(bid_index))
+    {
+        bbo.bid_int_price = order_book_.GetBidIntPrice(bid_index);
+        bbo.bid_size = order_book_.GetBidSize(bid_index);
+        bbo.bid_ordercount = order_book_.GetBidOrders(bid_index);
+    }
+    const int ask_index = order_book_.GetBaseAskIndex();
+    if (order_book_.initial_book_constructed_ && !order_book_.IsAskLevelEmpty(ask_index))
+    {
+        bbo.ask_int_price = order_book_.GetAskIntPrice(ask_index);
+        bbo.ask_size = order_book_.GetAskSize(ask_index);
+        bbo.ask_ordercount = order_book_.GetAskOrders(ask_index);
+    }
+    published_bbo_.Store(bbo);
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::SetPublishedDepth(int t_num_levels_)
+{
+    if (!owned_published_levels_)
+    {
+        owned_published_levels_.reset(new SeqLock<BookSnapshot>());
+    }
+    PublishLevelsTo(*owned_published_levels_, t_num_levels_);
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::PublishLevelsTo(SeqLock<BookSnapshot> &t_levels_, int t_num_levels_)
+{
+    published_levels_ = &t_levels_;
+    published_depth_ = std::max(0, std::min(t_num_levels_, BOOK_SNAPSHOT_MAX_LEVELS));
+    PublishTopOfBook(0);
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::ReportAnomaly(BookAnomaly t_anomaly_, uint8_t t_side_, uint64_t t_order_id_,
+                                                         int64_t t_value_)
+{
+    anomaly_counts_[t_anomaly_]++;
+    if (log_channel_ != nullptr)
+    {
+        log_channel_->Log(t_anomaly_, t_side_, t_order_id_, t_value_);
+    }
+}
+
+template <typename LevelListener>
+OrderNode *BasicOrderBookManager<LevelListener>::NewOrderNode(uint64_t t_order_id_, int t_size_)
+{
+    OrderNode *order_node = order_node_pool_.Allocate();
+    if (order_node == nullptr)
+    {
+        ReportAnomaly(BOOK_ANOMALY_NODE_POOL_EXHAUSTED, '-', t_order_id_, t_size_);
+        return nullptr;
+    }
+    order_node->order_id_ = t_order_id_;
+    order_node->size_ = t_size_;
+    return order_node;
+}
+
+template <typename LevelListener>
+const OrderNode *BasicOrderBookManager<LevelListener>::GetOrderNode(uint64_t t_order_id_, uint8_t t_side_)
+{
+    const OrderInfo *order_info = nullptr;
+    if (t_side_ == 'B')
+    {
+        order_info = order_id_to_bid_order_info_map_.Find(t_order_id_);
+    }
+    else if (t_side_ == 'S')
+    {
+        order_info = order_id_to_ask_order_info_map_.Find(t_order_id_);
+    }
+    return (order_info != nullptr ? order_info->node : nullptr);
+}
+
+template <typename LevelListener>
+const OrderInfo *BasicOrderBookManager<LevelListener>::FindOrder(uint64_t t_order_id_) const
+{
+    const OrderInfo *order_info = order_id_to_bid_order_info_map_.Find(t_order_id_);
+    return (order_info != nullptr ? order_info : order_id_to_ask_order_info_map_.Find(t_order_id_));
+}
+
+template <typename LevelListener>
+OrderInfo *BasicOrderBookManager<LevelListener>::FindOrder(uint64_t t_order_id_)
+{
+    // the orders of a refresh only reach the maps once it ends
+    if (is_bulk_loading_)
+    {
+        OnOrderResetEnd();
+    }
+    OrderInfo *order_info = order_id_to_bid_order_info_map_.Find(t_order_id_);
+    return (order_info != nullptr ? order_info : order_id_to_ask_order_info_map_.Find(t_order_id_));
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::UpdateBaseBidIndex()
+{
+    order_book_.bid_book_.UpdateBaseIndex();
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::UpdateBaseAskIndex()
+{
+    order_book_.ask_book_.UpdateBaseIndex();
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::OnEvent(const OrderEvent &t_event_)
+{
+    switch (t_event_.type)
+    {
+    case ORDER_EVENT_ADD:
+        OnOrderAdd(t_event_.order_id, t_event_.side, t_event_.price, t_event_.size);
+        break;
+    case ORDER_EVENT_DELETE:
+        OnOrderDelete(t_event_.order_id, t_event_.side);
+        break;
+    case ORDER_EVENT_MODIFY:
+        OnOrderModify(t_event_.order_id, t_event_.side, t_event_.size, t_event_.new_order_id);
+        break;
+    case ORDER_EVENT_REPLACE:
+        OnOrderReplace(t_event_.order_id, t_event_.side, t_event_.price, t_event_.size, t_event_.new_order_id);
+        break;
+    case ORDER_EVENT_EXEC:
+        OnOrderExec(t_event_.order_id, t_event_.side, t_event_.price, t_event_.size);
+        break;
+    default:
+        ReportAnomaly(BOOK_ANOMALY_UNKNOWN_EVENT_TYPE, t_event_.side, t_event_.order_id, t_event_.type);
+        break;
+    }
+}
+
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::PrefetchOrder(const OrderEvent &t_event_) const
+{
+    GetOrderInfoMap<S>().Prefetch(t_event_.order_id);
+}
+
+/*
+ * An add or replace carries the price of the level it goes to. Everything else only has an
+ * order id, its level is found through the map slot prefetched by PrefetchOrder. The book
+ * may still change before the event is applied, which only makes the prefetch useless
+ */
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::PrefetchLevel(const OrderEvent &t_event_)
+{
+    const SideBook<S> &side_book = order_book_.GetSideBook<S>();
+    if (t_event_.type == ORDER_EVENT_ADD || t_event_.type == ORDER_EVENT_REPLACE)
+    {
+        side_book.PrefetchLevel(order_book_.GetIntPx(t_event_.price));
+        if (t_event_.type == ORDER_EVENT_ADD)
+        {
+            return;
+        }
+    }
+
+    const OrderInfo *order_info = GetOrderInfoMap<S>().Find(t_event_.order_id);
+    if (order_info != nullptr)
+    {
+        side_book.PrefetchLevel(order_info->int_price);
+        if (order_info->node != nullptr)
+        {
+            __builtin_prefetch(order_info->node, 1);
+        }
+    }
+}
+
+template <typename LevelListener>
+void BasicOrderBookManager<LevelListener>::ProcessBatch(const OrderEvent *t_events_, size_t t_num_events_)
+{
+    for (size_t i = 0; i < t_num_events_; i++)
+    {
+        if (i + 2 * BATCH_PREFETCH_DISTANCE < t_num_events_)
+        {
+            const OrderEvent &event = t_events_[i + 2 * BATCH_PREFETCH_DISTANCE];
+            if (event.side == 'B')
+            {
+                PrefetchOrder<BID_SIDE>(event);
+            }
+            else if (event.side == 'S')
+            {
+                PrefetchOrder<ASK_SIDE>(event);
+            }
+        }
+
+        if (i + BATCH_PREFETCH_DISTANCE < t_num_events_ && order_book_.initial_book_constructed_)
+        {
+            const OrderEvent &event = t_events_[i + BATCH_PREFETCH_DISTANCE];
+            if (event.side == 'B')
+            {
+                PrefetchLevel<BID_SIDE>(event);
+            }
+            else if (event.side == 'S')
+            {
+                PrefetchLevel<ASK_SIDE>(event);
+            }
+        }
+
+        OnEvent(t_events_[i]);
+    }
+}
+
+/*
+ * In L3 mode the orders are written level by level in queue order, so LoadCheckpoint can
+ * rebuild the queues with plain appends. Orders without a queue node follow at the end
+ */
+template <typename LevelListener>
+template <Side S>
+bool BasicOrderBookManager<LevelListener>::WriteCheckpointOrders(FILE *t_file_)
+{
+    const SideBook<S> &side_book = order_book_.GetSideBook<S>();
+    const FlatHashMap<OrderInfo> &order_info_map = GetOrderInfoMap<S>();
+
+    size_t num_written = 0;
+    BookCheckpointOrder order;
+    std::unordered_set<uint64_t> queued_order_ids;
+    if (l3_mode_)
+    {
+        queued_order_ids.reserve(order_info_map.size());
+        // the levels of the overflow tier first, then the window
+        const int num_overflow_levels = side_book.overflow_levels_.size();
+        for (int level = 0; level < num_overflow_levels + (int)side_book.max_tick_range_; level++)
+        {
+            const OrderNode *front_order = (level < num_overflow_levels
+                                                ? side_book.overflow_levels_[level].order_queue.first_order_
+                                                : side_book.GetFrontOrder(level - num_overflow_levels));
+            for (const OrderNode *node = front_order; node != nullptr; node = node->next_)
+            {
+                const OrderInfo *order_info = order_info_map.Find(node->order_id_);
+                if (order_info == nullptr || order_info->node != node)
+                {
+                    continue;
+                }
+                order.order_id = node->order_id_;
+                order.int_price = order_info->int_price;
+                order.size = order_info->size;
+                num_written += fwrite(&order, sizeof(order), 1, t_file_);
+                queued_order_ids.insert(node->order_id_);
+            }
+        }
+    }
+
+    order_info_map.ForEach([&](uint64_t t_order_id_, const OrderInfo &t_order_info_) {
+        if (queued_order_ids.count(t_order_id_) != 0)
+        {
+            return;
+        }
+        order.order_id = t_order_id_;
+        order.int_price = t_order_info_.int_price;
+        order.size = t_order_info_.size;
+        num_written += fwrite(&order, sizeof(order), 1, t_file_);
+    });
+    return num_written == order_info_map.size();
+}
+
+template <typename LevelListener>
+template <Side S>
+bool BasicOrderBookManager<LevelListener>::WriteCheckpointOverflowLevels(FILE *t_file_)
+{
+    const std::vector<OverflowLevel> &overflow_levels = order_book_.GetSideBook<S>().overflow_levels_;
+
+    size_t num_written = 0;
+    BookCheckpointLevel level;
+    for (const OverflowLevel &overflow_level : overflow_levels)
+    {
+        level.int_price = overflow_level.int_price;
+        level.size = overflow_level.size;
+        level.ordercount = overflow_level.ordercount;
+        num_written += fwrite(&level, sizeof(level), 1, t_file_);
+    }
+    return num_written == overflow_levels.size();
+}
+
+template <typename LevelListener>
+bool BasicOrderBookManager<LevelListener>::SaveCheckpoint(const std::string &t_file_name_,
+                                                          BookCheckpointStatus *t_status_)
+{
+    const int max_tick_range = order_book_.max_tick_range_;
+
+    BookCheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = BOOK_CHECKPOINT_MAGIC;
+    header.version = BOOK_CHECKPOINT_VERSION;
+    header.l3_mode = l3_mode_;
+    strncpy(header.symbol, order_book_.exchange_symbol_.c_str(), BOOK_CHECKPOINT_SYMBOL_LENGTH - 1);
+    header.min_price_increment = order_book_.min_price_increment_;
+    header.max_tick_range = max_tick_range;
+    header.initial_book_constructed = order_book_.initial_book_constructed_;
+    header.sides[BID_SIDE].base_index = order_book_.bid_book_.base_index_;
+    header.sides[BID_SIDE].first_int_price = order_book_.bid_book_.first_int_price_;
+    header.sides[BID_SIDE].num_orders = order_id_to_bid_order_info_map_.size();
+    header.sides[BID_SIDE].num_overflow_levels = order_book_.bid_book_.overflow_levels_.size();
+    header.sides[ASK_SIDE].base_index = order_book_.ask_book_.base_index_;
+    header.sides[ASK_SIDE].first_int_price = order_book_.ask_book_.first_int_price_;
+    header.sides[ASK_SIDE].num_orders = order_id_to_ask_order_info_map_.size();
+    header.sides[ASK_SIDE].num_overflow_levels = order_book_.ask_book_.overflow_levels_.size();
+
+    FILE *file = fopen(t_file_name_.c_str(), "wb");
+    if (file == nullptr)
+    {
+        SetCheckpointStatus(t_status_, BOOK_CHECKPOINT_CANNOT_CREATE);
+        return false;
+    }
+
+    std::vector<int> sizes(max_tick_range);
+    std::vector<int> ordercounts(max_tick_range);
+    bool is_written = (fwrite(&header, sizeof(header), 1, file) == 1);
+
+    order_book_.bid_book_.CopyLevelsTo(sizes.data(), ordercounts.data());
+    is_written = is_written && fwrite(sizes.data(), sizeof(int), max_tick_range, file) == (size_t)max_tick_range;
+    is_written = is_written && fwrite(ordercounts.data(), sizeof(int), max_tick_range, file) == (size_t)max_tick_range;
+    order_book_.ask_book_.CopyLevelsTo(sizes.data(), ordercounts.data());
+    is_written = is_written && fwrite(sizes.data(), sizeof(int), max_tick_range, file) == (size_t)max_tick_range;
+    is_written = is_written && fwrite(ordercounts.data(), sizeof(int), max_tick_range, file) == (size_t)max_tick_range;
+
+    is_written = is_written && WriteCheckpointOrders<BID_SIDE>(file);
+    is_written = is_written && WriteCheckpointOrders<ASK_SIDE>(file);
+    is_written = is_written && WriteCheckpointOverflowLevels<BID_SIDE>(file);
+    is_written = is_written && WriteCheckpointOverflowLevels<ASK_SIDE>(file);
+
+    if (fclose(file) != 0 || !is_written)
+    {
+        SetCheckpointStatus(t_status_, BOOK_CHECKPOINT_WRITE_FAILED);
+        unlink(t_file_name_.c_str());
+        return false;
+    }
+    SetCheckpointStatus(t_status_, BOOK_CHECKPOINT_OK);
+    return true;
+}
+
+template <typename LevelListener>
+template <Side S>
+bool BasicOrderBookManager<LevelListener>::RestoreCheckpointOrders(const BookCheckpointOrder *t_orders_,
+                                                                   size_t t_num_orders_, bool t_has_queues_)
+{
+    SideBook<S> &side_book = order_book_.GetSideBook<S>();
+    FlatHashMap<OrderInfo> &order_info_map = GetOrderInfoMap<S>();
+
+    for (size_t i = 0; i < t_num_orders_; i++)
+    {
+        const BookCheckpointOrder &order = t_orders_[i];
+        OrderInfo *order_info =
+            order_info_map.Insert(order.order_id, OrderInfo(order.int_price, order.size, SideBook<S>::SIDE_CHAR));
+        if (order_info == nullptr)
+        {
+            return false;
+        }
+
+        // the levels, overflow tier included, are already restored, only the queues are left
+        const int index = side_book.GetIndex(order.int_price);
+        if (t_has_queues_ && index < (int)side_book.max_tick_range_)
+        {
+            order_info->node = NewOrderNode(order.order_id, order.size);
+            if (order_info->node != nullptr)
+            {
+                side_book.AppendOrder(index, order_info->node);
+            }
+        }
+    }
+    return true;
+}
+
+template <typename LevelListener>
+template <Side S>
+void BasicOrderBookManager<LevelListener>::RestoreCheckpointOverflowLevels(const BookCheckpointLevel *t_levels_,
+                                                                           size_t t_num_levels_)
+{
+    SideBook<S> &side_book = order_book_.GetSideBook<S>();
+    for (size_t i = 0; i < t_num_levels_; i++)
+    {
+        side_book.RestoreOverflowLevel(t_levels_[i].int_price, t_levels_[i].size, t_levels_[i].ordercount);
+    }
+}
+
+template <typename LevelListener>
+bool BasicOrderBookManager<LevelListener>::LoadCheckpoint(const std::string &t_file_name_,
+                                                          BookCheckpointStatus *t_status_)
+{
+    int fd = open(t_file_name_.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        SetCheckpointStatus(t_status_, BOOK_CHECKPOINT_CANNOT_OPEN);
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size < (off_t)sizeof(BookCheckpointHeader))
+    {
+        SetCheckpointStatus(t_status_, BOOK_CHECKPOINT_TOO_SHORT);
+        close(fd);
+        return false;
+    }
+    void *mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        SetCheckpointStatus(t_status_, BOOK_CHECKPOINT_CANNOT_MAP);
+        return false;
+    }
+
+    const char *data = static_cast<const char *>(mapped);
+    const BookCheckpointHeader &header = *reinterpret_cast<const BookCheckpointHeader *>(data);
+    const size_t max_tick_range = order_book_.max_tick_range_;
+    const size_t num_bid_orders = header.sides[BID_SIDE].num_orders;
+    const size_t num_ask_orders = header.sides[ASK_SIDE].num_orders;
+    const size_t num_bid_overflow_levels = header.sides[BID_SIDE].num_overflow_levels;
+    const size_t num_ask_overflow_levels = header.sides[ASK_SIDE].num_overflow_levels;
+    const size_t levels_size = 4 * max_tick_range * sizeof(int);
+    const size_t orders_size = (num_bid_orders + num_ask_orders) * sizeof(BookCheckpointOrder);
+    const size_t overflow_levels_size =
+        (num_bid_overflow_levels + num_ask_overflow_levels) * sizeof(BookCheckpointLevel);
+
+    BookCheckpointStatus status = BOOK_CHECKPOINT_OK;
+    if (header.magic != BOOK_CHECKPOINT_MAGIC || header.version != BOOK_CHECKPOINT_VERSION)
+    {
+        status = BOOK_CHECKPOINT_WRONG_VERSION;
+    }
+    else if (strncmp(header.symbol, order_book_.exchange_symbol_.c_str(), BOOK_CHECKPOINT_SYMBOL_LENGTH - 1) != 0 ||
+             header.min_price_increment != order_book_.min_price_increment_ || header.max_tick_range != max_tick_range)
+    {
+        status = BOOK_CHECKPOINT_OTHER_BOOK;
+    }
+    else if ((size_t)file_stat.st_size != sizeof(header) + levels_size + orders_size + overflow_levels_size)
+    {
+        status = BOOK_CHECKPOINT_WRONG_SIZE;
+    }
+    else if (num_bid_orders > order_id_to_bid_order_info_map_.capacity() ||
+             num_ask_orders > order_id_to_ask_order_info_map_.capacity())
+    {
+        status = BOOK_CHECKPOINT_TOO_MANY_ORDERS;
+    }
+    else if (l3_mode_ && !header.l3_mode)
+    {
+        status = BOOK_CHECKPOINT_NO_QUEUES;
+    }
+    if (status != BOOK_CHECKPOINT_OK)
+    {
+        SetCheckpointStatus(t_status_, status);
+        munmap(mapped, file_stat.st_size);
+        return false;
+    }
+
+    const int *levels = reinterpret_cast<const int *>(data + sizeof(header));
+    const BookCheckpointOrder *bid_orders =
+        reinterpret_cast<const BookCheckpointOrder *>(data + sizeof(header) + levels_size);
+    const BookCheckpointOrder *ask_orders = bid_orders + num_bid_orders;
+    const BookCheckpointLevel *bid_overflow_levels =
+        reinterpret_cast<const BookCheckpointLevel *>(ask_orders + num_ask_orders);
+    const BookCheckpointLevel *ask_overflow_levels = bid_overflow_levels + num_bid_overflow_levels;
+
+    order_book_.Initialize();
+    order_id_to_bid_order_info_map_.Clear();
+    order_id_to_ask_order_info_map_.Clear();
+    order_node_pool_.Reset();
+    is_bulk_loading_ = false;
+    bulk_orders_.clear();
+
+    order_book_.bid_book_.RestoreLevels(levels, levels + max_tick_range, header.sides[BID_SIDE].base_index,
+                                        header.sides[BID_SIDE].first_int_price);
+    order_book_.ask_book_.RestoreLevels(levels + 2 * max_tick_range, levels + 3 * max_tick_range,
+                                        header.sides[ASK_SIDE].base_index, header.sides[ASK_SIDE].first_int_price);
+    RestoreCheckpointOverflowLevels<BID_SIDE>(bid_overflow_levels, num_bid_overflow_levels);
+    RestoreCheckpointOverflowLevels<ASK_SIDE>(ask_overflow_levels, num_ask_overflow_levels);
+    order_book_.initial_book_constructed_ = (header.initial_book_constructed != 0);
+
+    // an order map can still refuse a key past its probe limit, the book is left flushed then
+    bool is_restored = RestoreCheckpointOrders<BID_SIDE>(bid_orders, num_bid_orders, l3_mode_) &&
+                       RestoreCheckpointOrders<ASK_SIDE>(ask_orders, num_ask_orders, l3_mode_);
+    munmap(mapped, file_stat.st_size);
+
+    if (!is_restored)
+    {
+        SetCheckpointStatus(t_status_, BOOK_CHECKPOINT_ORDERS_NOT_STORED);
+        order_book_.Initialize();
+        order_id_to_bid_order_info_map_.Clear();
+        order_id_to_ask_order_info_map_.Clear();
+        order_node_pool_.Reset();
+    }
+    else
+    {
+        SetCheckpointStatus(t_status_, BOOK_CHECKPOINT_OK);
+    }
+    PublishTopOfBook(0);
+    return is_restored;
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef ORDER_EVENT_HPP
+#define ORDER_EVENT_HPP
+
+#include <cstdint>
+
+// Event types, stored in OrderEvent::type
+#define ORDER_EVENT_ADD 'A'
+#define ORDER_EVENT_DELETE 'D'
+#define ORDER_EVENT_MODIFY 'M'
+#define ORDER_EVENT_REPLACE 'R'
+#define ORDER_EVENT_EXEC 'E'
+
+/*
+ * Fixed-width binary record for one OrderBookManager event. A replay file is
+ * nothing but a packed array of these in native byte order, so it can be
+ * memory mapped and walked without any decoding.
+ *
+ *  type         : one of ORDER_EVENT_*
+ *  side         : 'B' or 'S'
+ *  size         : order size for add/modify/replace, executed size for exec
+ *  order_id     : order the event applies to
+ *  new_order_id : new order id for modify/replace, unused otherwise
+ *  price        : order price for add/replace, trade price for exec
+ */
+struct OrderEvent
+{
+    uint8_t type;
+    uint8_t side;
+    uint16_t reserved;
+    int32_t size;
+    uint64_t order_id;
+    uint64_t new_order_id;
+    double price;
+};
+
+static_assert(sizeof(OrderEvent) == 32, "OrderEvent must stay a 32 byte record");
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef ORDER_QUEUE_HPP
+#define ORDER_QUEUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "book_memory.hpp"
+
+// One resting order in an L3 book, linked into the FIFO of its price level
+struct OrderNode
+{
+    uint64_t order_id_;
+    int size_;
+    OrderNode *prev_; // towards the front of the queue (earlier orders)
+    OrderNode *next_; // towards the back of the queue (later orders)
+};
+
+/*
+ * Intrusive FIFO of the orders resting at one price level, in time priority.
+ * The queue doesn't own the nodes, it only links them, so append/unlink are O(1).
+ */
+struct OrderQueue
+{
+    OrderNode *first_order_;
+    OrderNode *last_order_;
+
+    OrderQueue() : first_order_(nullptr), last_order_(nullptr) {}
+
+    void Clear()
+    {
+        first_order_ = nullptr;
+        last_order_ = nullptr;
+    }
+
+    void PushBack(OrderNode *t_node_)
+    {
+        t_node_->prev_ = last_order_;
+        t_node_->next_ = nullptr;
+        if (last_order_ != nullptr)
+        {
+            last_order_->next_ = t_node_;
+        }
+        else
+        {
+            first_order_ = t_node_;
+        }
+        last_order_ = t_node_;
+    }
+
+    // Safe on a node whose level has been reset since it was queued, then only its neighbours are relinked
+    void Remove(OrderNode *t_node_)
+    {
+        if (t_node_->prev_ != nullptr)
+        {
+            t_node_->prev_->next_ = t_node_->next_;
+        }
+        if (t_node_->next_ != nullptr)
+        {
+            t_node_->next_->prev_ = t_node_->prev_;
+        }
+        if (first_order_ == t_node_)
+        {
+            first_order_ = t_node_->next_;
+        }
+        if (last_order_ == t_node_)
+        {
+            last_order_ = t_node_->prev_;
+        }
+        t_node_->prev_ = nullptr;
+        t_node_->next_ = nullptr;
+    }
+};
+
+/*
+ * Fixed pool of OrderNodes, allocated once up front. Allocate/Release just pop/push
+ * the free list, so order nodes never come from the heap while the book is running.
+ */
+class OrderNodePool
+{
+  private:
+    BookVector<OrderNode> nodes_;
+    OrderNode *free_list_;
+    size_t num_used_;
+
+  public:
+    explicit OrderNodePool(size_t t_capacity_) : nodes_(t_capacity_), free_list_(nullptr), num_used_(0) { Reset(); }
+
+    // what a pool of @t_capacity_ nodes takes from its BookMemoryResource
+    static size_t GetMemorySize(size_t t_capacity_) { return GetBookAllocationSize(t_capacity_ * sizeof(OrderNode)); }
+
+    // returns nullptr once all nodes are in use
+    OrderNode *Allocate()
+    {
+        OrderNode *node = free_list_;
+        if (node != nullptr)
+        {
+            free_list_ = node->next_;
+            node->prev_ = nullptr;
+            node->next_ = nullptr;
+            num_used_++;
+        }
+        return node;
+    }
+
+    void Release(OrderNode *t_node_)
+    {
+        t_node_->prev_ = nullptr;
+        t_node_->next_ = free_list_;
+        free_list_ = t_node_;
+        num_used_--;
+    }
+
+    // puts every node back on the free list
+    void Reset()
+    {
+        free_list_ = nullptr;
+        for (size_t index = nodes_.size(); index > 0; index--)
+        {
+            nodes_[index - 1].prev_ = nullptr;
+            nodes_[index - 1].next_ = free_list_;
+            free_list_ = &nodes_[index - 1];
+        }
+        num_used_ = 0;
+    }
+
+    size_t size() const { return num_used_; }
+
+    size_t capacity() const { return nodes_.size(); }
+};
+
+#endif
@@ -0,0 +1,350 @@
+#include "perf_counters.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// reads taken back to back at Open, the smallest difference is the overhead of a batch
+#define PERF_OVERHEAD_SAMPLES 1000
+
+static const char *perf_event_type_names[NUM_PERF_EVENT_TYPES] = {"add", "delete", "modify", "replace", "exec", "other"};
+
+const char *GetPerfCounterName(PerfCounter t_counter_)
+{
+    switch (t_counter_)
+    {
+    case PERF_COUNTER_INSTRUCTIONS:
+        return "instructions";
+    case PERF_COUNTER_CYCLES:
+        return "cycles";
+    case PERF_COUNTER_CACHE_MISSES:
+        return "cache-misses";
+    case PERF_COUNTER_BRANCH_MISSES:
+        return "branch-misses";
+    case PERF_COUNTER_DTLB_MISSES:
+        return "dTLB-misses";
+    default:
+        return "unknown";
+    }
+}
+
+static void SetPerfEventConfig(PerfCounter t_counter_, struct perf_event_attr &t_attr_)
+{
+    t_attr_.type = PERF_TYPE_HARDWARE;
+    switch (t_counter_)
+    {
+    case PERF_COUNTER_INSTRUCTIONS:
+        t_attr_.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PERF_COUNTER_CYCLES:
+        t_attr_.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PERF_COUNTER_CACHE_MISSES:
+        t_attr_.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case PERF_COUNTER_BRANCH_MISSES:
+        t_attr_.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    case PERF_COUNTER_DTLB_MISSES:
+    default:
+        t_attr_.type = PERF_TYPE_HW_CACHE;
+        t_attr_.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    }
+}
+
+PerfCounterGroup::PerfCounterGroup() : leader_fd_(-1)
+{
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+    {
+        fds_[counter] = -1;
+        ids_[counter] = 0;
+    }
+}
+
+PerfCounterGroup::~PerfCounterGroup() { Close(); }
+
+bool PerfCounterGroup::Open()
+{
+    Close();
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        SetPerfEventConfig((PerfCounter)counter, attr);
+        attr.read_format =
+            PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        // this thread, any cpu
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader_fd_, 0);
+        if (fd < 0)
+        {
+            continue;
+        }
+        if (ioctl(fd, PERF_EVENT_IOC_ID, &ids_[counter]) != 0)
+        {
+            close(fd);
+            continue;
+        }
+        fds_[counter] = fd;
+        if (leader_fd_ < 0)
+        {
+            leader_fd_ = fd;
+        }
+    }
+    return leader_fd_ >= 0;
+}
+
+void PerfCounterGroup::Close()
+{
+    // members first, the leader last
+    for (int counter = NUM_PERF_COUNTERS - 1; counter >= 0; counter--)
+    {
+        if (fds_[counter] >= 0)
+        {
+            close(fds_[counter]);
+            fds_[counter] = -1;
+        }
+    }
+    leader_fd_ = -1;
+}
+
+bool PerfCounterGroup::Read(PerfCounterReading &t_reading_) const
+{
+    // nr, time enabled, time running, then a value and id per counter of the group
+    uint64_t buffer[3 + 2 * NUM_PERF_COUNTERS];
+    memset(&t_reading_, 0, sizeof(t_reading_));
+    if (leader_fd_ < 0 || read(leader_fd_, buffer, sizeof(buffer)) < (ssize_t)(3 * sizeof(uint64_t)))
+    {
+        return false;
+    }
+
+    const uint64_t num_values = buffer[0];
+    t_reading_.time_enabled = buffer[1];
+    t_reading_.time_running = buffer[2];
+    for (uint64_t value = 0; value < num_values && value < NUM_PERF_COUNTERS; value++)
+    {
+        for (int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+        {
+            if (fds_[counter] >= 0 && ids_[counter] == buffer[4 + 2 * value])
+            {
+                t_reading_.values[counter] = buffer[3 + 2 * value];
+            }
+        }
+    }
+    return true;
+}
+
+PerfEventProfile::PerfEventProfile()
+{
+    memset(read_overhead_, 0, sizeof(read_overhead_));
+    memset(&batch_start_, 0, sizeof(batch_start_));
+    memset(totals_, 0, sizeof(totals_));
+    memset(time_enabled_, 0, sizeof(time_enabled_));
+    memset(time_running_, 0, sizeof(time_running_));
+    memset(num_events_, 0, sizeof(num_events_));
+    memset(num_batches_, 0, sizeof(num_batches_));
+    memset(num_unscheduled_batches_, 0, sizeof(num_unscheduled_batches_));
+}
+
+int PerfEventProfile::GetEventTypeIndex(uint8_t t_event_type_)
+{
+    switch (t_event_type_)
+    {
+    case ORDER_EVENT_ADD:
+        return 0;
+    case ORDER_EVENT_DELETE:
+        return 1;
+    case ORDER_EVENT_MODIFY:
+        return 2;
+    case ORDER_EVENT_REPLACE:
+        return 3;
+    case ORDER_EVENT_EXEC:
+        return 4;
+    default:
+        return NUM_PERF_EVENT_TYPES - 1;
+    }
+}
+
+bool PerfEventProfile::Open()
+{
+    if (!counters_.Open())
+    {
+        std::cout << " perf_event_open failed for every hardware counter (no PMU exposed, or perf_event_paranoid "
+                     "too high)\n";
+        return false;
+    }
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+    {
+        if (!counters_.IsAvailable((PerfCounter)counter))
+        {
+            std::cout << " " << GetPerfCounterName((PerfCounter)counter) << " is not available, reported as -\n";
+        }
+    }
+
+    PerfCounterReading before;
+    PerfCounterReading after;
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+    {
+        read_overhead_[counter] = UINT64_MAX;
+    }
+    for (int sample = 0; sample < PERF_OVERHEAD_SAMPLES; sample++)
+    {
+        counters_.Read(before);
+        counters_.Read(after);
+        // only pairs the group ran through, a pair it missed reads as no cost at all
+        if (after.time_running - before.time_running != after.time_enabled - before.time_enabled)
+        {
+            continue;
+        }
+        for (int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+        {
+            read_overhead_[counter] = std::min(read_overhead_[counter], after.values[counter] - before.values[counter]);
+        }
+    }
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+    {
+        if (read_overhead_[counter] == UINT64_MAX)
+        {
+            read_overhead_[counter] = 0;
+        }
+    }
+    return true;
+}
+
+void PerfEventProfile::EndBatch(uint8_t t_event_type_, size_t t_num_events_)
+{
+    PerfCounterReading batch_end;
+    counters_.Read(batch_end);
+
+    const int type_index = GetEventTypeIndex(t_event_type_);
+    const uint64_t time_running = batch_end.time_running - batch_start_.time_running;
+    time_enabled_[type_index] += batch_end.time_enabled - batch_start_.time_enabled;
+    time_running_[type_index] += time_running;
+    if (time_running == 0)
+    {
+        // the counters read 0, the scaling in Print makes up for it
+        num_unscheduled_batches_[type_index]++;
+    }
+    else
+    {
+        for (int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+        {
+            const uint64_t delta = batch_end.values[counter] - batch_start_.values[counter];
+            totals_[type_index][counter] += (delta > read_overhead_[counter] ? delta - read_overhead_[counter] : 0);
+        }
+    }
+    num_events_[type_index] += t_num_events_;
+    num_batches_[type_index]++;
+}
+
+void PerfEventProfile::Print(std::ostream &t_stream_) const
+{
+    char line[192];
+    snprintf(line, sizeof(line), "  %-8s %10s %10s %6s %13s %10s %8s %13s %13s %13s\n", "type", "events", "batches",
+             "run%", "instructions", "cycles", "IPC", "cache-misses", "branch-misses", "dTLB-misses");
+    t_stream_ << line;
+
+    double all_totals[NUM_PERF_COUNTERS];
+    uint64_t all_events = 0;
+    uint64_t all_batches = 0;
+    uint64_t all_time_enabled = 0;
+    uint64_t all_time_running = 0;
+    uint64_t all_unscheduled_batches = 0;
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+    {
+        all_totals[counter] = 0.0;
+    }
+
+    for (int type_index = 0; type_index <= NUM_PERF_EVENT_TYPES; type_index++)
+    {
+        const bool is_all = (type_index == NUM_PERF_EVENT_TYPES);
+        const uint64_t num_events = (is_all ? all_events : num_events_[type_index]);
+        const uint64_t num_batches = (is_all ? all_batches : num_batches_[type_index]);
+        const uint64_t time_enabled = (is_all ? all_time_enabled : time_enabled_[type_index]);
+        const uint64_t time_running = (is_all ? all_time_running : time_running_[type_index]);
+        if (num_events == 0)
+        {
+            continue;
+        }
+
+        // counts over the time the group ran, scaled up to the time it was enabled
+        double totals[NUM_PERF_COUNTERS];
+        for (int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+        {
+            if (is_all)
+            {
+                totals[counter] = all_totals[counter];
+            }
+            else
+            {
+                totals[counter] = (time_running != 0 && time_running < time_enabled
+                                       ? (double)totals_[type_index][counter] * time_enabled / time_running
+                                       : (double)totals_[type_index][counter]);
+                all_totals[counter] += totals[counter];
+            }
+        }
+        if (!is_all)
+        {
+            all_events += num_events;
+            all_batches += num_batches;
+            all_time_enabled += time_enabled;
+            all_time_running += time_running;
+            all_unscheduled_batches += num_unscheduled_batches_[type_index];
+        }
+
+        // nothing to report for a type the group never ran through
+        const bool has_run = (time_running != 0);
+        char run_percent[24] = "-";
+        if (time_enabled != 0)
+        {
+            snprintf(run_percent, sizeof(run_percent), "%.1f", 100.0 * time_running / time_enabled);
+        }
+        char values[NUM_PERF_COUNTERS][24];
+        for (int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+        {
+            if (has_run && counters_.IsAvailable((PerfCounter)counter))
+            {
+                snprintf(values[counter], sizeof(values[counter]), "%.2f", totals[counter] / num_events);
+            }
+            else
+            {
+                snprintf(values[counter], sizeof(values[counter]), "-");
+            }
+        }
+        char ipc[24] = "-";
+        if (has_run && counters_.IsAvailable(PERF_COUNTER_INSTRUCTIONS) && counters_.IsAvailable(PERF_COUNTER_CYCLES) &&
+            totals[PERF_COUNTER_CYCLES] != 0.0)
+        {
+            snprintf(ipc, sizeof(ipc), "%.2f", totals[PERF_COUNTER_INSTRUCTIONS] / totals[PERF_COUNTER_CYCLES]);
+        }
+
+        snprintf(line, sizeof(line), "  %-8s %10llu %10llu %6s %13s %10s %8s %13s %13s %13s\n",
+                 (is_all ? "all" : perf_event_type_names[type_index]), (unsigned long long)num_events,
+                 (unsigned long long)num_batches, run_percent, values[PERF_COUNTER_INSTRUCTIONS],
+                 values[PERF_COUNTER_CYCLES], ipc, values[PERF_COUNTER_CACHE_MISSES],
+                 values[PERF_COUNTER_BRANCH_MISSES], values[PERF_COUNTER_DTLB_MISSES]);
+        t_stream_ << line;
+    }
+
+    if (all_time_running < all_time_enabled)
+    {
+        t_stream_ << "  The counters were multiplexed (run% under 100), the values are scaled up from the time they "
+                     "ran and are estimates\n";
+    }
+    if (all_unscheduled_batches != 0)
+    {
+        t_stream_ << "  " << all_unscheduled_batches << " of " << all_batches
+                  << " batches ran with the counters off the PMU and read nothing\n";
+    }
+}
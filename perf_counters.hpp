@@ -0,0 +1,120 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include "order_event.hpp"
+
+// Hardware events counted by a PerfCounterGroup
+enum PerfCounter
+{
+    PERF_COUNTER_INSTRUCTIONS = 0,
+    PERF_COUNTER_CYCLES,
+    PERF_COUNTER_CACHE_MISSES,  // last level cache
+    PERF_COUNTER_BRANCH_MISSES, // mispredicted branches
+    PERF_COUNTER_DTLB_MISSES,   // data TLB read misses
+    NUM_PERF_COUNTERS
+};
+
+const char *GetPerfCounterName(PerfCounter t_counter_);
+
+// One read of a PerfCounterGroup
+struct PerfCounterReading
+{
+    uint64_t values[NUM_PERF_COUNTERS];
+    uint64_t time_enabled; // ns the group has been enabled
+    uint64_t time_running; // ns it was actually counting, less than enabled when the kernel multiplexed it
+};
+
+/*
+ * The PerfCounters of the calling thread, opened with perf_event_open as one group so they are
+ * scheduled together and read with a single read(). Only user space is counted, the read itself
+ * and interrupts don't show up. A counter the cpu or the kernel doesn't offer (virtual machines,
+ * perf_event_paranoid) is left out and reads as 0, IsAvailable tells which. When other events
+ * compete for the PMU the kernel time slices the group: it then counts only part of the time,
+ * and not at all while it is off, which the enabled and running times of every read show.
+ */
+class PerfCounterGroup
+{
+  private:
+    int fds_[NUM_PERF_COUNTERS];
+    uint64_t ids_[NUM_PERF_COUNTERS];
+    int leader_fd_;
+
+  public:
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+
+    // false if none of the counters could be opened
+    bool Open();
+    void Close();
+
+    bool IsAvailable(PerfCounter t_counter_) const { return fds_[t_counter_] >= 0; }
+
+    // current value of every counter and the group's times, counting from Open
+    bool Read(PerfCounterReading &t_reading_) const;
+};
+
+// rows of a PerfEventProfile: one per OrderEvent type, the last one for anything else
+#define NUM_PERF_EVENT_TYPES 6
+
+/*
+ * Counter deltas around batches of manager calls, summed per OrderEvent type, so they can be
+ * reported per message. A batch is a run of consecutive events of one type, which is how a
+ * replay file is fed to it (ProfileEvents). The cost of the two reads around a batch is measured
+ * once at Open and taken off every batch. If the group was multiplexed, the counts of an event
+ * type are scaled up by the time it was enabled over the time it ran, as perf stat does, and Print
+ * says so. Batches during which the group didn't run at all are counted and reported.
+ */
+class PerfEventProfile
+{
+  private:
+    PerfCounterGroup counters_;
+    uint64_t read_overhead_[NUM_PERF_COUNTERS];
+    PerfCounterReading batch_start_;
+    uint64_t totals_[NUM_PERF_EVENT_TYPES][NUM_PERF_COUNTERS];
+    uint64_t time_enabled_[NUM_PERF_EVENT_TYPES];
+    uint64_t time_running_[NUM_PERF_EVENT_TYPES];
+    uint64_t num_events_[NUM_PERF_EVENT_TYPES];
+    uint64_t num_batches_[NUM_PERF_EVENT_TYPES];
+    uint64_t num_unscheduled_batches_[NUM_PERF_EVENT_TYPES]; // the group didn't run at all
+
+    static int GetEventTypeIndex(uint8_t t_event_type_);
+
+  public:
+    PerfEventProfile();
+
+    // false, after saying why, if no hardware counter is available
+    bool Open();
+
+    void BeginBatch() { counters_.Read(batch_start_); }
+    void EndBatch(uint8_t t_event_type_, size_t t_num_events_);
+
+    // per event type: events, batches, % of the time the counters ran, and every counter per event
+    // (plus IPC), then all types together and a note on any multiplexing
+    void Print(std::ostream &t_stream_) const;
+};
+
+// feeds @t_events_ to @t_manager_ through ProcessBatch, one batch per run of events of the same type
+template <typename Manager>
+void ProfileEvents(PerfEventProfile &t_profile_, Manager &t_manager_, const OrderEvent *t_events_,
+                   size_t t_num_events_)
+{
+    size_t batch_begin = 0;
+    while (batch_begin < t_num_events_)
+    {
+        size_t batch_end = batch_begin + 1;
+        while (batch_end < t_num_events_ && t_events_[batch_end].type == t_events_[batch_begin].type)
+        {
+            batch_end++;
+        }
+        t_profile_.BeginBatch();
+        t_manager_.ProcessBatch(&t_events_[batch_begin], batch_end - batch_begin);
+        t_profile_.EndBatch(t_events_[batch_begin].type, batch_end - batch_begin);
+        batch_begin = batch_end;
+    }
+}
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef PRICE_PARSER_HPP
+#define PRICE_PARSER_HPP
+
+#include <math.h>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+// Finest tick size the parser can represent exactly, 10^-PRICE_PARSER_MAX_DECIMALS
+#define PRICE_PARSER_MAX_DECIMALS 9
+
+/*
+ * Exact conversion of feed prices to ticks (price / min_price_increment), without going
+ * through a double. The tick size is turned once into an integer number of units of
+ * 10^-num_decimals_ (0.01 -> 1 unit of 10^-2, 0.05 -> 5 units of 10^-2), after that a
+ * price is parsed digit by digit into the same units and divided by the tick.
+ * A price that isn't a whole number of ticks is rejected rather than rounded.
+ */
+class PriceParser
+{
+  private:
+    int num_decimals_;
+    int64_t tick_units_;
+
+    static int64_t Pow10(int t_exponent_)
+    {
+        static const int64_t pow10[] = {1LL,
+                                        10LL,
+                                        100LL,
+                                        1000LL,
+                                        10000LL,
+                                        100000LL,
+                                        1000000LL,
+                                        10000000LL,
+                                        100000000LL,
+                                        1000000000LL,
+                                        10000000000LL,
+                                        100000000000LL,
+                                        1000000000000LL,
+                                        10000000000000LL,
+                                        100000000000000LL,
+                                        1000000000000000LL,
+                                        10000000000000000LL,
+                                        100000000000000000LL,
+                                        1000000000000000000LL};
+        return pow10[t_exponent_];
+    }
+
+    bool UnitsToTicks(int64_t t_units_, int &t_int_price_) const
+    {
+        if (t_units_ % tick_units_ != 0)
+        {
+            return false;
+        }
+        int64_t ticks = t_units_ / tick_units_;
+        if (ticks > INT_MAX || ticks < INT_MIN)
+        {
+            return false;
+        }
+        t_int_price_ = (int)ticks;
+        return true;
+    }
+
+  public:
+    explicit PriceParser(double t_min_price_increment_) : num_decimals_(PRICE_PARSER_MAX_DECIMALS), tick_units_(1)
+    {
+        for (int decimals = 0; decimals <= PRICE_PARSER_MAX_DECIMALS; decimals++)
+        {
+            double scaled = t_min_price_increment_ * Pow10(decimals);
+            if (fabs(scaled - llround(scaled)) < 1e-6)
+            {
+                num_decimals_ = decimals;
+                break;
+            }
+        }
+        tick_units_ = llround(t_min_price_increment_ * Pow10(num_decimals_));
+        if (tick_units_ <= 0)
+        {
+            tick_units_ = 1;
+        }
+    }
+
+    /*
+     * Parses the decimal price in [@t_begin_, @t_end_), e.g. "101.25", "-0.5" or "7", the range
+     * doesn't have to be NUL terminated. Returns false on anything else than an optional sign,
+     * digits and one '.', on overflow, or when the price is not on the tick grid.
+     */
+    bool Parse(const char *t_begin_, const char *t_end_, int &t_int_price_) const
+    {
+        const char *cursor = t_begin_;
+        bool is_negative = false;
+        if (cursor != t_end_ && (*cursor == '-' || *cursor == '+'))
+        {
+            is_negative = (*cursor == '-');
+            cursor++;
+        }
+
+        int64_t units = 0;
+        int num_digits = 0;
+        for (; cursor != t_end_ && *cursor >= '0' && *cursor <= '9'; cursor++)
+        {
+            // keeps units * 10^num_decimals_ below 10^18
+            if (++num_digits > 18 - num_decimals_)
+            {
+                return false;
+            }
+            units = units * 10 + (*cursor - '0');
+        }
+
+        int num_fraction_digits = 0;
+        if (cursor != t_end_ && *cursor == '.')
+        {
+            for (cursor++; cursor != t_end_ && *cursor >= '0' && *cursor <= '9'; cursor++)
+            {
+                if (num_fraction_digits < num_decimals_)
+                {
+                    units = units * 10 + (*cursor - '0');
+                    num_fraction_digits++;
+                }
+                else if (*cursor != '0')
+                {
+                    // finer than the tick size
+                    return false;
+                }
+                num_digits++;
+            }
+        }
+
+        if (cursor != t_end_ || num_digits == 0)
+        {
+            return false;
+        }
+
+        units *= Pow10(num_decimals_ - num_fraction_digits);
+        return UnitsToTicks(is_negative ? -units : units, t_int_price_);
+    }
+
+    bool Parse(const char *t_str_, int &t_int_price_) const { return Parse(t_str_, t_str_ + strlen(t_str_), t_int_price_); }
+
+    // @t_value_ with @t_num_decimals_ implied decimals (e.g. a price field of 1012500 with 4 decimals is 101.25)
+    bool FromFixedPoint(int64_t t_value_, int t_num_decimals_, int &t_int_price_) const
+    {
+        if (t_num_decimals_ < 0 || t_num_decimals_ > 18)
+        {
+            return false;
+        }
+        if (t_num_decimals_ > num_decimals_)
+        {
+            int64_t divisor = Pow10(t_num_decimals_ - num_decimals_);
+            if (t_value_ % divisor != 0)
+            {
+                return false;
+            }
+            return UnitsToTicks(t_value_ / divisor, t_int_price_);
+        }
+
+        int64_t multiplier = Pow10(num_decimals_ - t_num_decimals_);
+        if (t_value_ > INT64_MAX / multiplier || t_value_ < INT64_MIN / multiplier)
+        {
+            return false;
+        }
+        return UnitsToTicks(t_value_ * multiplier, t_int_price_);
+    }
+
+    int GetNumDecimals() const { return num_decimals_; }
+};
+
+#endif
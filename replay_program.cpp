@@ -0,0 +1,165 @@
+#include "book_memory.hpp"
+#include "order_book_manager.hpp"
+#include "perf_counters.hpp"
+#include "shm_book.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+/*
+ * Replays a binary file of OrderEvent records through OrderBookManager as fast
+ * as the book can take them. The file is memory mapped and every record is
+ * dispatched straight into the handlers (ProcessBatch), nothing is copied or allocated per event.
+ * With a shared memory name the top levels are published there while replaying
+ * (see shm_reader_program.cpp).
+ * With --perf the file is fed in runs of events of one type, with the hardware counters read
+ * around every run, and the counts per event of each type are printed at the end (perf_counters.hpp).
+ */
+int main(int argc, char **argv)
+{
+    bool perf_mode = false;
+    std::vector<const char *> args;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--perf") == 0)
+        {
+            perf_mode = true;
+        }
+        else
+        {
+            args.push_back(argv[i]);
+        }
+    }
+
+    if (args.size() < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <event_file> <min_price_increment> [symbol [shm_name]] [--perf]\n";
+        return 1;
+    }
+
+    const char *event_file = args[0];
+    double min_price_increment = atof(args[1]);
+    std::string symbol = (args.size() > 2 ? args[2] : "AMAZON");
+    std::string shm_name = (args.size() > 3 ? args[3] : "");
+
+    if (min_price_increment <= 0.0)
+    {
+        std::cerr << "min_price_increment has to be positive\n";
+        return 1;
+    }
+
+    int fd = open(event_file, O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Could not open " << event_file << "\n";
+        return 1;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size % sizeof(OrderEvent) != 0)
+    {
+        std::cerr << event_file << " is not a whole number of " << sizeof(OrderEvent) << " byte records\n";
+        close(fd);
+        return 1;
+    }
+
+    size_t num_events = file_stat.st_size / sizeof(OrderEvent);
+    if (num_events == 0)
+    {
+        std::cerr << event_file << " has no events\n";
+        close(fd);
+        return 1;
+    }
+
+    void *mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        std::cerr << "Could not mmap " << event_file << "\n";
+        return 1;
+    }
+    madvise(mapped, file_stat.st_size, MADV_SEQUENTIAL);
+
+    const OrderEvent *events = static_cast<const OrderEvent *>(mapped);
+
+    // the whole book in one mapping, faulted in on this thread
+    BookArena book_arena(OrderBookManager::GetMemorySize());
+    ScopedBookMemoryResource book_memory(&book_arena);
+    OrderBook ob(symbol, min_price_increment);
+    OrderBookManager om(ob);
+
+    // errors in the feed are formatted and written by the logger thread, off the replay loop
+    AsyncLogger logger(std::cout);
+    om.SetLogChannel(logger.NewChannel());
+    logger.Start();
+
+    ShmBookPublisher shm_publisher;
+    if (!shm_name.empty())
+    {
+        if (!shm_publisher.Open(shm_name, symbol, min_price_increment))
+        {
+            munmap(mapped, file_stat.st_size);
+            return 1;
+        }
+        om.PublishLevelsTo(shm_publisher.GetLevels(), BOOK_SNAPSHOT_MAX_LEVELS);
+    }
+
+    PerfEventProfile perf_profile;
+    if (perf_mode && !perf_profile.Open())
+    {
+        munmap(mapped, file_stat.st_size);
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (perf_mode)
+    {
+        ProfileEvents(perf_profile, om, events, num_events);
+    }
+    else
+    {
+        om.ProcessBatch(events, num_events);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    double wall_time = std::chrono::duration<double>(end - start).count();
+    logger.Stop();
+
+    std::cout << om.ShowMarket();
+    std::cout << "Events replayed : " << num_events << "\n";
+    std::cout << "Wall time (s)   : " << wall_time << "\n";
+    std::cout << "Events/sec      : " << (wall_time > 0.0 ? num_events / wall_time : 0.0) << "\n";
+    for (int anomaly = 0; anomaly < NUM_BOOK_ANOMALIES; anomaly++)
+    {
+        uint64_t count = om.GetAnomalyCount((BookAnomaly)anomaly);
+        if (count != 0)
+        {
+            std::cout << "Anomaly " << GetBookAnomalyName((BookAnomaly)anomaly) << " : " << count << "\n";
+        }
+    }
+    if (logger.GetNumDropped() != 0)
+    {
+        std::cout << "Log records dropped : " << logger.GetNumDropped() << "\n";
+    }
+    const HugePageMemoryResource &memory = GetHugePageMemoryResource();
+    std::cout << "Book memory (KB) : " << memory.GetHugePageBytes() / 1024 << " huge pages, "
+              << memory.GetTransparentHugePageBytes() / 1024 << " transparent huge pages, "
+              << memory.GetSmallPageBytes() / 1024 << " small pages\n";
+#if LATENCY_PROBES_ON
+    DumpBookProbes(ob.GetProbes(), std::cout);
+#endif
+    if (perf_mode)
+    {
+        perf_profile.Print(std::cout);
+    }
+
+    munmap(mapped, file_stat.st_size);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#ifndef SEQLOCK_HPP
+#define SEQLOCK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "cpu_relax.hpp"
+
+/*
+ * Single writer, many readers publication of a small trivially copyable T.
+ *
+ * The writer makes the sequence number odd, copies the value in, and makes it even
+ * again; it never waits for anybody. A reader copies the value out between two reads
+ * of the sequence number and keeps the copy only if both were the same even number,
+ * otherwise the writer was in the middle of a store and the reader tries again.
+ * The value is stored as 64 bit relaxed atomics, so a torn read is a retry and never
+ * a data race. The record is padded on both sides so it doesn't share a cache line
+ * with whatever is next to it, and it only holds lock-free atomics, so it also works
+ * when placed in memory shared between processes.
+ */
+template <typename T>
+class SeqLock
+{
+    static_assert(sizeof(T) % sizeof(uint64_t) == 0, "SeqLock value size has to be a multiple of 8 bytes");
+
+  private:
+    enum
+    {
+        NUM_WORDS = sizeof(T) / sizeof(uint64_t)
+    };
+
+    char front_pad_[CACHE_LINE_SIZE];
+    std::atomic<uint64_t> sequence_;
+    std::atomic<uint64_t> words_[NUM_WORDS];
+    char back_pad_[CACHE_LINE_SIZE];
+
+  public:
+    SeqLock() : sequence_(0)
+    {
+        for (int word = 0; word < NUM_WORDS; word++)
+        {
+            words_[word].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // writer only
+    void Store(const T &t_value_)
+    {
+        uint64_t words[NUM_WORDS];
+        memcpy(words, &t_value_, sizeof(T));
+
+        const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int word = 0; word < NUM_WORDS; word++)
+        {
+            words_[word].store(words[word], std::memory_order_relaxed);
+        }
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    // false if a store was in progress, @t_value_ is left untouched then
+    bool TryLoad(T &t_value_) const
+    {
+        const uint64_t sequence = sequence_.load(std::memory_order_acquire);
+        if (sequence & 1)
+        {
+            return false;
+        }
+
+        uint64_t words[NUM_WORDS];
+        for (int word = 0; word < NUM_WORDS; word++)
+        {
+            words[word] = words_[word].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) != sequence)
+        {
+            return false;
+        }
+
+        memcpy(&t_value_, words, sizeof(T));
+        return true;
+    }
+
+    // spins until it gets a consistent copy, only ever waits for a store in progress
+    void Load(T &t_value_) const
+    {
+        while (!TryLoad(t_value_))
+        {
+            CpuRelax();
+        }
+    }
+
+    // number of completed stores times 2, changes whenever the value may have changed
+    uint64_t GetSequence() const { return sequence_.load(std::memory_order_acquire); }
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "shm_book.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+#include <new>
+
+bool ShmBookPublisher::Open(const std::string &t_name_, const std::string &t_symbol_, double t_min_price_increment_)
+{
+    Close();
+
+    shm_unlink(t_name_.c_str());
+    int fd = shm_open(t_name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        std::cout << " Could not create shared memory segment " << t_name_ << "\n";
+        return false;
+    }
+    if (ftruncate(fd, sizeof(ShmBookSegment)) != 0)
+    {
+        std::cout << " Could not size shared memory segment " << t_name_ << "\n";
+        close(fd);
+        shm_unlink(t_name_.c_str());
+        return false;
+    }
+
+    void *mapped = mmap(nullptr, sizeof(ShmBookSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        std::cout << " Could not map shared memory segment " << t_name_ << "\n";
+        shm_unlink(t_name_.c_str());
+        return false;
+    }
+
+    segment_ = new (mapped) ShmBookSegment();
+    segment_->version = SHM_BOOK_VERSION;
+    segment_->snapshot_size = sizeof(BookSnapshot);
+    strncpy(segment_->symbol, t_symbol_.c_str(), SHM_BOOK_SYMBOL_LENGTH - 1);
+    segment_->symbol[SHM_BOOK_SYMBOL_LENGTH - 1] = '\0';
+    segment_->min_price_increment = t_min_price_increment_;
+
+    BookSnapshot empty_snapshot;
+    memset(&empty_snapshot, 0, sizeof(empty_snapshot));
+    empty_snapshot.min_price_increment = t_min_price_increment_;
+    segment_->book.Store(empty_snapshot);
+
+    // readers only trust the header once the magic is there
+    segment_->magic.store(SHM_BOOK_MAGIC, std::memory_order_release);
+    name_ = t_name_;
+    return true;
+}
+
+void ShmBookPublisher::Close()
+{
+    if (segment_ == nullptr)
+    {
+        return;
+    }
+    segment_->~ShmBookSegment();
+    munmap(segment_, sizeof(ShmBookSegment));
+    shm_unlink(name_.c_str());
+    segment_ = nullptr;
+    name_.clear();
+}
+
+bool ShmBookReader::Open(const std::string &t_name_)
+{
+    Close();
+
+    int fd = shm_open(t_name_.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat segment_stat;
+    if (fstat(fd, &segment_stat) != 0 || segment_stat.st_size != (off_t)sizeof(ShmBookSegment))
+    {
+        close(fd);
+        return false;
+    }
+
+    void *mapped = mmap(nullptr, sizeof(ShmBookSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const ShmBookSegment *segment = static_cast<const ShmBookSegment *>(mapped);
+    if (segment->magic.load(std::memory_order_acquire) != SHM_BOOK_MAGIC || segment->version != SHM_BOOK_VERSION ||
+        segment->snapshot_size != sizeof(BookSnapshot))
+    {
+        munmap(mapped, sizeof(ShmBookSegment));
+        return false;
+    }
+    segment_ = segment;
+    return true;
+}
+
+void ShmBookReader::Close()
+{
+    if (segment_ == nullptr)
+    {
+        return;
+    }
+    munmap(const_cast<ShmBookSegment *>(segment_), sizeof(ShmBookSegment));
+    segment_ = nullptr;
+}
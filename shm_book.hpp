@@ -0,0 +1,85 @@
+#ifndef SHM_BOOK_HPP
+#define SHM_BOOK_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "book_snapshot.hpp"
+#include "seqlock.hpp"
+
+#define SHM_BOOK_MAGIC 0x4b4f4f42324c4d53ull // "SML2BOOK"
+#define SHM_BOOK_VERSION 1
+#define SHM_BOOK_SYMBOL_LENGTH 32
+
+/*
+ * Layout of a shared memory book segment (/dev/shm/<name>). The header is written
+ * once by the publisher, magic last, and never changes after that; the book is a
+ * seqlocked BookSnapshot rewritten by the publisher and read by any number of
+ * processes. version and snapshot_size let a reader refuse a segment written by a
+ * build with another layout.
+ */
+struct ShmBookSegment
+{
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    uint32_t snapshot_size;
+    char symbol[SHM_BOOK_SYMBOL_LENGTH];
+    double min_price_increment;
+    SeqLock<BookSnapshot> book;
+};
+
+/*
+ * Creates and owns a book segment. Hand GetLevels() to OrderBookManager::PublishLevelsTo
+ * and the manager keeps the segment up to date as events come in. The segment is
+ * removed from /dev/shm when the publisher is closed, readers that already mapped it
+ * keep their mapping.
+ */
+class ShmBookPublisher
+{
+  private:
+    std::string name_;
+    ShmBookSegment *segment_;
+
+  public:
+    ShmBookPublisher() : name_(), segment_(nullptr) {}
+    ~ShmBookPublisher() { Close(); }
+
+    // @t_name_ is a POSIX shared memory name, e.g. "/book_AMAZON". Replaces any segment of that name.
+    bool Open(const std::string &t_name_, const std::string &t_symbol_, double t_min_price_increment_);
+    void Close();
+
+    bool IsOpen() const { return segment_ != nullptr; }
+
+    SeqLock<BookSnapshot> &GetLevels() { return segment_->book; }
+};
+
+/*
+ * Maps a segment written by ShmBookPublisher read-only. Read never blocks the
+ * publisher, it only retries while a snapshot is being rewritten.
+ */
+class ShmBookReader
+{
+  private:
+    const ShmBookSegment *segment_;
+
+  public:
+    ShmBookReader() : segment_(nullptr) {}
+    ~ShmBookReader() { Close(); }
+
+    // false if the segment doesn't exist (yet) or has a different layout
+    bool Open(const std::string &t_name_);
+    void Close();
+
+    bool IsOpen() const { return segment_ != nullptr; }
+
+    void Read(BookSnapshot &t_snapshot_) const { segment_->book.Load(t_snapshot_); }
+    bool TryRead(BookSnapshot &t_snapshot_) const { return segment_->book.TryLoad(t_snapshot_); }
+
+    // changes whenever the published book may have changed, to poll without copying it
+    uint64_t GetSequence() const { return segment_->book.GetSequence(); }
+
+    std::string GetSymbol() const { return segment_->symbol; }
+    double GetMinPriceIncrement() const { return segment_->min_price_increment; }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "order_book.hpp"
+#include "shm_book.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+/*
+ * Prints the book published in a shared memory segment by another process (e.g.
+ * order_replay with a shm_name), every time it changes but at most once per interval.
+ * The segment is only read, the publisher is never slowed down by this.
+ */
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <shm_name> [interval_ms] [--once]\n";
+        return 1;
+    }
+
+    const char *shm_name = argv[1];
+    int interval_ms = 1000;
+    bool once = false;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--once") == 0)
+        {
+            once = true;
+        }
+        else
+        {
+            interval_ms = atoi(argv[i]);
+        }
+    }
+
+    ShmBookReader reader;
+    while (!reader.Open(shm_name))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    uint64_t last_sequence = 0;
+    BookSnapshot snapshot;
+    while (true)
+    {
+        uint64_t sequence = reader.GetSequence();
+        if (sequence != last_sequence)
+        {
+            reader.Read(snapshot);
+            std::cout << OrderBook::FormatSnapshot(reader.GetSymbol(), snapshot) << "\n";
+            last_sequence = sequence;
+        }
+        if (once)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+    return 0;
+}
@@ -0,0 +1,779 @@
+#ifndef SIDE_BOOK_HPP
+#define SIDE_BOOK_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <typeinfo>
+#include <vector>
+
+#include "book_probes.hpp"
+#include "book_snapshot.hpp"
+#include "level_bitmap.hpp"
+#include "level_kernels.hpp"
+#include "order_queue.hpp"
+
+#define LOW_ACCESS_INDEX 50
+#define DEBUG_MODE_ON 0
+
+enum Side
+{
+    BID_SIDE = 0,
+    ASK_SIDE = 1
+};
+
+// a level behind the window, kept by the overflow tier of a SideBook
+struct OverflowLevel
+{
+    int int_price;
+    int size;
+    int ordercount;
+    OrderQueue order_queue;
+};
+
+/*
+ * The price levels of one side of the book.
+ *
+ * On both sides a higher index is a better price, the side only decides which way the
+ * prices run: level @index is at first_int_price_ + index on the bid side and at
+ * first_int_price_ - index on the ask side. DIRECTION is a compile time constant, so
+ * every branch on the side folds away and bids and asks share a single code path.
+ *
+ * Levels live in a ring of max_tick_range_ (a power of two) slots: level @index is stored in slot
+ * (index + ring_offset_) & level_mask_. Re-centring moves the ring offset instead of the levels.
+ * Each field has its own array, so a scan over sizes only pulls sizes into cache.
+ *
+ * Levels worse than the window (negative index) go to the overflow tier, a vector of
+ * OverflowLevels sorted worst first. Only orders far from the touch land there, so it stays
+ * short and a binary search plus an insert at the back end is cheap. The level functions take
+ * a negative index and route it to the overflow tier, so callers don't care which tier a level
+ * is in. The tiers exchange levels lazily when the window slides: levels rolling out at the
+ * bottom are appended to the overflow tier, and levels the window slides down over are pulled back.
+ */
+template <Side S>
+struct SideBook
+{
+    // +1 if prices go up with the index (bids), -1 if they go down (asks)
+    static const int DIRECTION = (S == BID_SIDE ? 1 : -1);
+    static const char SIDE_CHAR = (S == BID_SIDE ? 'B' : 'S');
+    static const Side OPPOSITE_SIDE = (S == BID_SIDE ? ASK_SIDE : BID_SIDE);
+
+    static const char *GetName() { return (S == BID_SIDE ? "Bid" : "Ask"); }
+
+    BookVector<int> sizes_;       // cumulative size at each level
+    BookVector<int> ordercounts_; // cumulative count of orders at each level
+
+    // per level FIFO of resting orders, only populated when the manager runs in L3 mode.
+    // Kept apart from the levels so the aggregate-only (L2) path doesn't pay for it in cache.
+    BookVector<OrderQueue> order_queues_;
+
+    // bit per slot, set when the level is non-empty, kept in sync by UpdateLevel/ResetLevel
+    LevelBitmap level_bitmap_;
+
+    // non-empty levels worse than index 0, worst first. Empty if the window is empty
+    std::vector<OverflowLevel> overflow_levels_;
+
+    // best level, or the level it was last at if the side is empty
+    unsigned int base_index_;
+
+    unsigned int initial_tick_size_;
+    unsigned int max_tick_range_;
+    unsigned int level_mask_;
+    unsigned int ring_offset_;
+
+    // integer price of the level at index 0
+    int first_int_price_;
+
+#if LATENCY_PROBES_ON
+    // those of the OrderBook holding this side
+    BookProbes *probes_;
+#endif
+
+    SideBook()
+        : base_index_(0u),
+          initial_tick_size_(0u),
+          max_tick_range_(0u),
+          level_mask_(0u),
+          ring_offset_(0u),
+          first_int_price_(0)
+    {
+#if LATENCY_PROBES_ON
+        probes_ = nullptr;
+#endif
+    }
+
+    // @t_max_tick_range_ has to be a power of two
+    void Initialize(unsigned int t_initial_tick_size_, unsigned int t_max_tick_range_)
+    {
+        initial_tick_size_ = t_initial_tick_size_;
+        max_tick_range_ = t_max_tick_range_;
+        level_mask_ = max_tick_range_ - 1;
+        ring_offset_ = 0;
+
+        sizes_.assign(max_tick_range_, 0);
+        ordercounts_.assign(max_tick_range_, 0);
+        order_queues_.assign(max_tick_range_, OrderQueue());
+        level_bitmap_.Resize(max_tick_range_);
+        overflow_levels_.clear();
+    }
+
+    // what Initialize with @t_max_tick_range_ takes from the BookMemoryResource
+    static size_t GetMemorySize(unsigned int t_max_tick_range_)
+    {
+        return 2 * GetBookAllocationSize(t_max_tick_range_ * sizeof(int)) +
+               GetBookAllocationSize(t_max_tick_range_ * sizeof(OrderQueue)) + LevelBitmap::GetMemorySize(t_max_tick_range_);
+    }
+
+    int GetSlot(int index) const { return (index + ring_offset_) & level_mask_; }
+
+    int GetIndex(int int_price) const { return DIRECTION * (int_price - first_int_price_); }
+
+    int GetIntPrice(int index) const { return (index >= 0 ? first_int_price_ + DIRECTION * index : 0); }
+
+    int GetSize(int index) const
+    {
+        if (index < 0)
+        {
+            const OverflowLevel *level = FindOverflowLevel(index);
+            return (level != nullptr ? level->size : 0);
+        }
+        return sizes_[GetSlot(index)];
+    }
+
+    int GetOrders(int index) const
+    {
+        if (index < 0)
+        {
+            const OverflowLevel *level = FindOverflowLevel(index);
+            return (level != nullptr ? level->ordercount : 0);
+        }
+        return ordercounts_[GetSlot(index)];
+    }
+
+    // first order in time priority at the level (L3 mode only), follow next_ for the rest of the queue
+    const OrderNode *GetFrontOrder(int index) const
+    {
+        if (index < 0)
+        {
+            const OverflowLevel *level = FindOverflowLevel(index);
+            return (level != nullptr ? level->order_queue.first_order_ : nullptr);
+        }
+        return order_queues_[GetSlot(index)].first_order_;
+    }
+
+    OrderNode *GetFrontOrder(int index)
+    {
+        return const_cast<OrderNode *>(static_cast<const SideBook *>(this)->GetFrontOrder(index));
+    }
+
+    // position in overflow_levels_ of the first level not worse than @t_int_price_
+    size_t GetOverflowPosition(int t_int_price_) const
+    {
+        size_t low = 0;
+        size_t high = overflow_levels_.size();
+        while (low < high)
+        {
+            const size_t mid = (low + high) / 2;
+            if (IsBetter(t_int_price_, overflow_levels_[mid].int_price))
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    // overflow level at @index (below 0), nullptr if it is empty
+    const OverflowLevel *FindOverflowLevel(int index) const
+    {
+        const int int_price = first_int_price_ + DIRECTION * index;
+        const size_t position = GetOverflowPosition(int_price);
+        if (position < overflow_levels_.size() && overflow_levels_[position].int_price == int_price)
+        {
+            return &overflow_levels_[position];
+        }
+        return nullptr;
+    }
+
+    OverflowLevel *FindOverflowLevel(int index)
+    {
+        return const_cast<OverflowLevel *>(static_cast<const SideBook *>(this)->FindOverflowLevel(index));
+    }
+
+    // empty levels are erased, a new level is inserted in price order
+    void UpdateOverflowLevel(int index, int size, int ordercount)
+    {
+        const int int_price = first_int_price_ + DIRECTION * index;
+        const size_t position = GetOverflowPosition(int_price);
+        const bool is_present =
+            (position < overflow_levels_.size() && overflow_levels_[position].int_price == int_price);
+
+        if (size <= 0 || ordercount <= 0)
+        {
+            if (is_present)
+            {
+                overflow_levels_.erase(overflow_levels_.begin() + position);
+            }
+            return;
+        }
+
+        if (!is_present)
+        {
+            OverflowLevel new_level;
+            new_level.int_price = int_price;
+            overflow_levels_.insert(overflow_levels_.begin() + position, new_level);
+        }
+        overflow_levels_[position].size = size;
+        overflow_levels_[position].ordercount = ordercount;
+    }
+
+    // is @t_int_price_ a better price than @t_other_int_price_ on this side
+    static bool IsBetter(int t_int_price_, int t_other_int_price_)
+    {
+        return DIRECTION * (t_int_price_ - t_other_int_price_) > 0;
+    }
+
+    bool IsLevelEmpty(int index) const { return GetSize(index) <= 0 || GetOrders(index) <= 0; }
+
+    bool IsBookEmpty() const { return IsLevelEmpty(base_index_); }
+
+    void ResetLevel(int index)
+    {
+        if (index < 0)
+        {
+            UpdateOverflowLevel(index, 0, 0);
+            return;
+        }
+        const int slot = GetSlot(index);
+        sizes_[slot] = 0;
+        ordercounts_[slot] = 0;
+        order_queues_[slot].Clear();
+        level_bitmap_.Reset(slot);
+    }
+
+    void UpdateLevel(int index, int size, int ordercount)
+    {
+        if (index < 0)
+        {
+            UpdateOverflowLevel(index, size, ordercount);
+            return;
+        }
+        if (size < 0 || ordercount < 0)
+        {
+            ResetLevel(index);
+            return;
+        }
+
+        const int slot = GetSlot(index);
+        sizes_[slot] = size;
+        ordercounts_[slot] = ordercount;
+        if (size > 0 && ordercount > 0)
+        {
+            level_bitmap_.Set(slot);
+        }
+        else
+        {
+            level_bitmap_.Reset(slot);
+        }
+    }
+
+    // pulls the size and ordercount of the level at @t_int_price_ towards the cache, if it is in the window
+    void PrefetchLevel(int t_int_price_) const
+    {
+        const int index = GetIndex(t_int_price_);
+        if (index >= 0 && index < (int)max_tick_range_)
+        {
+            const int slot = GetSlot(index);
+            __builtin_prefetch(&sizes_[slot], 1);
+            __builtin_prefetch(&ordercounts_[slot], 1);
+        }
+    }
+
+    // the level has to be non-empty already when it is in the overflow tier
+    void AppendOrder(int index, OrderNode *node)
+    {
+        if (index < 0)
+        {
+            OverflowLevel *level = FindOverflowLevel(index);
+            if (level != nullptr)
+            {
+                level->order_queue.PushBack(node);
+            }
+            return;
+        }
+        order_queues_[GetSlot(index)].PushBack(node);
+    }
+
+    void RemoveOrder(int index, OrderNode *node)
+    {
+        if (index < 0)
+        {
+            // a level that is gone still has its neighbours relinked, as for a reset window level
+            OverflowLevel *level = FindOverflowLevel(index);
+            OrderQueue orphan_queue;
+            (level != nullptr ? level->order_queue : orphan_queue).Remove(node);
+            return;
+        }
+        order_queues_[GetSlot(index)].Remove(node);
+    }
+
+    /**
+     * Closest non-empty level worse than @index, -1 if there is none.
+     * The occupancy bitmap is indexed by slot, the search over indices [0, index) becomes
+     * at most two searches over slots, as the window can wrap around the end of the ring
+     */
+    int GetNextIndex(int index) const
+    {
+        if (index <= 0)
+        {
+            return -1;
+        }
+        const int first_slot = ring_offset_ & level_mask_;
+        const int slot = (index + ring_offset_) & level_mask_;
+
+        if (slot > first_slot)
+        {
+            int prev_slot = level_bitmap_.FindPrev(slot);
+            return (prev_slot >= first_slot ? prev_slot - first_slot : -1);
+        }
+
+        // window wraps: search [0, slot) first, then [first_slot, end of ring)
+        int prev_slot = level_bitmap_.FindPrev(slot);
+        if (prev_slot >= 0)
+        {
+            return prev_slot + (int)max_tick_range_ - first_slot;
+        }
+        prev_slot = level_bitmap_.FindPrev(max_tick_range_);
+        return (prev_slot >= first_slot ? prev_slot - first_slot : -1);
+    }
+
+    // number of non-empty levels with index in [low_index, high_index)
+    int GetLevelCount(int low_index, int high_index) const
+    {
+        low_index = std::max(low_index, 0);
+        high_index = std::min(high_index, (int)max_tick_range_);
+        if (low_index >= high_index)
+        {
+            return 0;
+        }
+        const int ring_size = max_tick_range_;
+        const int low_slot = GetSlot(low_index);
+        const int high_slot = low_slot + (high_index - low_index);
+
+        if (high_slot <= ring_size)
+        {
+            return level_bitmap_.Count(low_slot, high_slot);
+        }
+        return level_bitmap_.Count(low_slot, ring_size) + level_bitmap_.Count(0, high_slot - ring_size);
+    }
+
+    // number of non-empty levels better than @index, over both tiers
+    int GetLevelsAhead(int index) const
+    {
+        if (index >= 0)
+        {
+            return GetLevelCount(index + 1, base_index_ + 1);
+        }
+        const int int_price = first_int_price_ + DIRECTION * index;
+        size_t position = GetOverflowPosition(int_price);
+        if (position < overflow_levels_.size() && overflow_levels_[position].int_price == int_price)
+        {
+            position++;
+        }
+        return GetLevelCount(0, base_index_ + 1) + (int)(overflow_levels_.size() - position);
+    }
+
+    /**
+     * Size sum and size weighted distance (in ticks) from high_index over the levels [low_index, high_index],
+     * one kernel call per contiguous run of slots (two when the range wraps around the end of the ring)
+     */
+    void SumLevels(int low_index, int high_index, LevelSums &sums) const
+    {
+        sums = LevelSums();
+        low_index = std::max(low_index, 0);
+        high_index = std::min(high_index, (int)level_mask_);
+        if (low_index > high_index)
+        {
+            return;
+        }
+        const int ring_size = max_tick_range_;
+        const int count = high_index - low_index + 1;
+        const int low_slot = GetSlot(low_index);
+        const int first_run = std::min(count, ring_size - low_slot);
+
+        SumLevelSizes(&sizes_[low_slot], first_run, sums);
+        if (first_run < count)
+        {
+            // the second run starts first_run levels above low_index
+            LevelSums wrapped_sums;
+            SumLevelSizes(&sizes_[0], count - first_run, wrapped_sums);
+            sums.size_sum_ += wrapped_sums.size_sum_;
+            sums.weighted_sum_ += wrapped_sums.weighted_sum_ + (int64_t)first_run * wrapped_sums.size_sum_;
+        }
+        sums.weighted_sum_ = (int64_t)(count - 1) * sums.size_sum_ - sums.weighted_sum_;
+    }
+
+    // best non-empty level, -1 if the side is empty
+    int GetBestIndex() const
+    {
+        int best_index = base_index_;
+        if (best_index >= 0 && IsLevelEmpty(best_index))
+        {
+            best_index = GetNextIndex(best_index);
+        }
+        return best_index;
+    }
+
+    // size weighted average price of the top @num_levels non-empty levels, 0 if the side is empty
+    double GetVWAP(int num_levels, double t_min_price_increment_) const
+    {
+        const int best_index = GetBestIndex();
+        if (best_index < 0 || num_levels <= 0)
+        {
+            return 0.0;
+        }
+
+        int low_index = best_index;
+        int level = 1;
+        for (; level < num_levels; level++)
+        {
+            int next_index = GetNextIndex(low_index);
+            if (next_index < 0)
+            {
+                break;
+            }
+            low_index = next_index;
+        }
+
+        LevelSums sums;
+        SumLevels(low_index, best_index, sums);
+        // exact integer numerator, one rounding in the division
+        int64_t int_price_sum = (int64_t)GetIntPrice(best_index) * sums.size_sum_ - DIRECTION * sums.weighted_sum_;
+        int64_t size_sum = sums.size_sum_;
+
+        // the window ran out of levels, the rest come from the overflow tier
+        for (size_t position = overflow_levels_.size(); level < num_levels && position > 0; level++)
+        {
+            const OverflowLevel &overflow_level = overflow_levels_[--position];
+            int_price_sum += (int64_t)overflow_level.int_price * overflow_level.size;
+            size_sum += overflow_level.size;
+        }
+
+        if (size_sum == 0)
+        {
+            return 0.0;
+        }
+        return int_price_sum * t_min_price_increment_ / size_sum;
+    }
+
+    // total size at prices at least as good as @int_price, levels above the base index are empty
+    int64_t GetDepthToPrice(int int_price) const
+    {
+        LevelSums sums;
+        const int index = GetIndex(int_price);
+        SumLevels(index, base_index_, sums);
+        int64_t depth = sums.size_sum_;
+        if (index < 0)
+        {
+            for (size_t position = overflow_levels_.size(); position > 0; position--)
+            {
+                const OverflowLevel &overflow_level = overflow_levels_[position - 1];
+                if (IsBetter(int_price, overflow_level.int_price))
+                {
+                    break;
+                }
+                depth += overflow_level.size;
+            }
+        }
+        return depth;
+    }
+
+    // total size within @num_ticks of the best price
+    int64_t GetSizeWithinTicks(int num_ticks) const
+    {
+        return GetDepthToPrice(GetIntPrice(base_index_) - DIRECTION * num_ticks);
+    }
+
+    /**
+     * Copies the top @num_levels non-empty levels into @levels, best first, returns how many
+     * there were. @vwap gets their size weighted average price
+     */
+    int FillSnapshotLevels(SnapshotLevel *levels, int num_levels, double t_min_price_increment_, double &vwap) const
+    {
+        int64_t int_price_sum = 0;
+        int64_t size_sum = 0;
+        int num_filled = 0;
+        for (int index = GetBestIndex(); num_filled < num_levels && index >= 0; index = GetNextIndex(index))
+        {
+            SnapshotLevel &level = levels[num_filled++];
+            level.int_price = GetIntPrice(index);
+            level.size = GetSize(index);
+            level.ordercount = GetOrders(index);
+            int_price_sum += (int64_t)level.int_price * level.size;
+            size_sum += level.size;
+        }
+        for (size_t position = overflow_levels_.size(); num_filled < num_levels && position > 0;)
+        {
+            const OverflowLevel &overflow_level = overflow_levels_[--position];
+            SnapshotLevel &level = levels[num_filled++];
+            level.int_price = overflow_level.int_price;
+            level.size = overflow_level.size;
+            level.ordercount = overflow_level.ordercount;
+            int_price_sum += (int64_t)level.int_price * level.size;
+            size_sum += level.size;
+        }
+        vwap = (size_sum != 0 ? int_price_sum * t_min_price_increment_ / size_sum : 0.0);
+        return num_filled;
+    }
+
+    // lays the window out around the best price @t_int_price_, all levels empty
+    void Build(int t_int_price_)
+    {
+        base_index_ = initial_tick_size_;
+        ring_offset_ = 0;
+        first_int_price_ = t_int_price_ - DIRECTION * (int)base_index_;
+
+        for (int index_ = 0; index_ < (int)max_tick_range_; index_++)
+        {
+            ResetLevel(index_);
+        }
+        overflow_levels_.clear();
+    }
+
+    /**
+     * Rebuild/re-centre index when base_index_ moves past the upper limit
+     * Slide the window such that base_index_ (pointing to new_int_price_) is restored to
+     * initial_tick_size_. The levels live in a ring, so the levels that stay in the window keep their
+     * slot and only the ones rolling in at the top are cleared, O(ticks moved) rather than
+     * O(size of the ladder). The non-empty levels rolling out at the bottom move to the overflow
+     * tier, they are better than every level already there so they go to its back
+     */
+    void RebuildIndexHighAccess(int new_int_price_)
+    {
+#if DEBUG_MODE_ON
+        std::cout << typeid(*this).name() << ":" << __func__ << " " << " [" << SIDE_CHAR << "," << new_int_price_
+                  << "]" << std::endl;
+#endif
+        BOOK_PROBE_SCOPE(*probes_, BOOK_PROBE_REBUILD_HIGH);
+        BOOK_PROBE_COUNT(*probes_, BOOK_PATH_REBUILD_HIGH);
+        const int offset_ = DIRECTION * (new_int_price_ - GetIntPrice(initial_tick_size_));
+
+        const int num_rolled_out = std::min(offset_, (int)max_tick_range_);
+        for (int index_ = 0; index_ < num_rolled_out; index_++)
+        {
+            const int slot = GetSlot(index_);
+            if (level_bitmap_.Test(slot))
+            {
+                OverflowLevel level;
+                level.int_price = GetIntPrice(index_);
+                level.size = sizes_[slot];
+                level.ordercount = ordercounts_[slot];
+                level.order_queue = order_queues_[slot];
+                overflow_levels_.push_back(level);
+                BOOK_PROBE_COUNT(*probes_, BOOK_PATH_OVERFLOW_SPILL);
+            }
+        }
+
+        ring_offset_ += offset_;
+        first_int_price_ += DIRECTION * offset_;
+        base_index_ = initial_tick_size_;
+
+        int index_ = std::max((int)max_tick_range_ - offset_, 0);
+        for (; index_ < (int)max_tick_range_; index_++)
+        {
+            ResetLevel(index_);
+        }
+    }
+
+    /**
+     * Rebuild/re-centre index when base_index_ moves below the lower limit
+     * Slide the window such that base_index_ (pointing to new_int_price_) is restored to
+     * initial_tick_size_, only the levels rolling in at the bottom are cleared. Levels of the
+     * overflow tier the window now covers are moved back into their slots, best first from its back
+     */
+    void RebuildIndexLowAccess(int new_int_price_)
+    {
+#if DEBUG_MODE_ON
+        std::cout << typeid(*this).name() << ":" << __func__ << " " << " [" << SIDE_CHAR << "," << new_int_price_
+                  << "]" << std::endl;
+#endif
+        BOOK_PROBE_SCOPE(*probes_, BOOK_PROBE_REBUILD_LOW);
+        BOOK_PROBE_COUNT(*probes_, BOOK_PATH_REBUILD_LOW);
+        int offset_ = DIRECTION * (GetIntPrice(initial_tick_size_) - new_int_price_);
+
+        ring_offset_ -= offset_;
+        first_int_price_ -= DIRECTION * offset_;
+        base_index_ = initial_tick_size_;
+
+        // Offset can be quit huge, restrict size/price/ordercount resetting to the size of the window
+        offset_ = std::min(offset_, (int)max_tick_range_);
+
+        for (int index_ = 0; index_ < offset_; index_++)
+        {
+            ResetLevel(index_);
+        }
+
+        while (!overflow_levels_.empty())
+        {
+            const OverflowLevel &level = overflow_levels_.back();
+            const int index_ = GetIndex(level.int_price);
+            if (index_ < 0)
+            {
+                break;
+            }
+            const int slot = GetSlot(index_);
+            sizes_[slot] = level.size;
+            ordercounts_[slot] = level.ordercount;
+            order_queues_[slot] = level.order_queue;
+            level_bitmap_.Set(slot);
+            overflow_levels_.pop_back();
+        }
+    }
+
+    /**
+     * Index of the level at @t_int_price_, about to get size. The window is re-centred first if
+     * needed: around the price if the side is empty, up to it if it is better than the window.
+     * A price behind the window gets a negative index, its level is in the overflow tier
+     */
+    int PrepareLevel(int t_int_price_)
+    {
+        int index = GetIndex(t_int_price_);
+
+        // There are 0 levels on this side
+        if (IsBookEmpty())
+        {
+            if (index < LOW_ACCESS_INDEX)
+            {
+                RebuildIndexLowAccess(t_int_price_);
+                index = base_index_;
+            }
+            else if (index >= (int)max_tick_range_)
+            {
+                RebuildIndexHighAccess(t_int_price_);
+                index = base_index_;
+            }
+            base_index_ = index;
+        }
+
+        // new level is at a very good price
+        if (index >= (int)max_tick_range_)
+        {
+            RebuildIndexHighAccess(t_int_price_);
+            index = base_index_;
+        }
+        return index;
+    }
+
+    /**
+     * Overwrites the level at @t_int_price_ with an aggregate from a market by price feed,
+     * returns true if the level was empty before. A size or ordercount of 0 deletes it
+     */
+    bool SetLevel(int t_int_price_, int t_size_, int t_ordercount_)
+    {
+        if (t_size_ <= 0 || t_ordercount_ <= 0)
+        {
+            DeleteLevel(t_int_price_);
+            return false;
+        }
+        const int index = PrepareLevel(t_int_price_);
+        const bool is_new_level = IsLevelEmpty(index);
+        UpdateLevel(index, t_size_, t_ordercount_);
+        base_index_ = std::max((int)base_index_, index);
+        return is_new_level;
+    }
+
+    // empties the level at @t_int_price_, false if it was empty already
+    bool DeleteLevel(int t_int_price_)
+    {
+        const int index = GetIndex(t_int_price_);
+        if (index >= (int)max_tick_range_ || IsLevelEmpty(index))
+        {
+            return false;
+        }
+        ResetLevel(index);
+        if (index == (int)base_index_)
+        {
+            UpdateBaseIndex();
+        }
+        return true;
+    }
+
+    // copies the window out in index order, @t_sizes_ and @t_ordercounts_ hold max_tick_range_ entries
+    void CopyLevelsTo(int *t_sizes_, int *t_ordercounts_) const
+    {
+        for (int index_ = 0; index_ < (int)max_tick_range_; index_++)
+        {
+            t_sizes_[index_] = sizes_[GetSlot(index_)];
+            t_ordercounts_[index_] = ordercounts_[GetSlot(index_)];
+        }
+    }
+
+    // lays out a window copied by CopyLevelsTo, with empty order queues and no overflow tier
+    void RestoreLevels(const int *t_sizes_, const int *t_ordercounts_, unsigned int t_base_index_,
+                       int t_first_int_price_)
+    {
+        ring_offset_ = 0;
+        base_index_ = t_base_index_;
+        first_int_price_ = t_first_int_price_;
+        overflow_levels_.clear();
+        for (int index_ = 0; index_ < (int)max_tick_range_; index_++)
+        {
+            order_queues_[index_].Clear();
+            UpdateLevel(index_, t_sizes_[index_], t_ordercounts_[index_]);
+        }
+    }
+
+    // appends a level of the overflow tier after RestoreLevels, levels come worst price first
+    void RestoreOverflowLevel(int t_int_price_, int t_size_, int t_ordercount_)
+    {
+        OverflowLevel level;
+        level.int_price = t_int_price_;
+        level.size = t_size_;
+        level.ordercount = t_ordercount_;
+        overflow_levels_.push_back(level);
+    }
+
+    // the best level was emptied, move base_index_ down to the next non-empty one
+    void UpdateBaseIndex()
+    {
+        BOOK_PROBE_SCOPE(*probes_, BOOK_PROBE_BASE_INDEX);
+
+        // finding the next best index, empty levels in between are skipped through the occupancy bitmap
+        int next_index_ = GetNextIndex(base_index_);
+
+        if (next_index_ < 0)
+        {
+            // the window is empty, slide it down onto the best level of the overflow tier
+            if (!overflow_levels_.empty())
+            {
+                RebuildIndexLowAccess(overflow_levels_.back().int_price);
+            }
+            else
+            {
+                BOOK_PROBE_COUNT(*probes_, BOOK_PATH_SIDE_EMPTIED);
+            }
+            return;
+        }
+
+        base_index_ = next_index_; // updating the best level
+
+        if (base_index_ < LOW_ACCESS_INDEX)
+        {
+            RebuildIndexLowAccess(GetIntPrice(next_index_));
+        }
+    }
+};
+
+template <Side S>
+const int SideBook<S>::DIRECTION;
+
+template <Side S>
+const char SideBook<S>::SIDE_CHAR;
+
+template <Side S>
+const Side SideBook<S>::OPPOSITE_SIDE;
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "cpu_relax.hpp"
+
+/*
+ * Bounded lock-free queue for exactly one producer thread and one consumer thread.
+ * The capacity is rounded up to a power of two and allocated once. head_ is only
+ * written by the producer and tail_ only by the consumer, each on its own cache line,
+ * and each side keeps a cached copy of the other's index so it only reads the shared
+ * one when the queue looks full (producer) or empty (consumer).
+ * T has to be cheap to copy, elements are copied in and out of the slots.
+ */
+template <typename T>
+class SPSCQueue
+{
+  private:
+    std::vector<T> slots_;
+    size_t mask_;
+
+    char head_pad_[CACHE_LINE_SIZE];
+    std::atomic<size_t> head_; // next slot to write
+    size_t cached_tail_;       // producer's last view of tail_
+
+    char tail_pad_[CACHE_LINE_SIZE];
+    std::atomic<size_t> tail_; // next slot to read
+    size_t cached_head_;       // consumer's last view of head_
+
+    char end_pad_[CACHE_LINE_SIZE];
+
+  public:
+    explicit SPSCQueue(size_t t_capacity_) : slots_(), mask_(0), head_(0), cached_tail_(0), tail_(0), cached_head_(0)
+    {
+        size_t capacity = 2;
+        while (capacity < t_capacity_)
+        {
+            capacity <<= 1;
+        }
+        slots_.resize(capacity);
+        mask_ = capacity - 1;
+    }
+
+    // producer only, false when the queue is full
+    bool TryPush(const T &t_item_)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ > mask_)
+        {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ > mask_)
+            {
+                return false;
+            }
+        }
+        slots_[head & mask_] = t_item_;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only, false when the queue is empty
+    bool TryPop(T &t_item_)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_)
+        {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_)
+            {
+                return false;
+            }
+        }
+        t_item_ = slots_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximate when called while the other side is running
+    bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+    size_t capacity() const { return slots_.size(); }
+};
+
+#endif
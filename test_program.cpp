@@ -8,6 +8,10 @@ int main() {
     OrderBook ob("AMAZON", min_price_increment);
     OrderBookManager om(ob);
 
+    AsyncLogger logger(std::cout);
+    om.SetLogChannel(logger.NewChannel());
+    logger.Start();
+
     while(1) {
         int option;
         std::cout << "Choose the order type : \n";
@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <cmath>
+
+#include "workload_generator.hpp"
+
+WorkloadConfig::WorkloadConfig()
+    : name_("steady"),
+      seed_(1),
+      num_events_(1000000),
+      min_price_increment_(0.01),
+      start_int_price_(10000),
+      add_weight_(45),
+      cancel_weight_(30),
+      modify_weight_(10),
+      replace_weight_(5),
+      exec_weight_(10),
+      mean_tick_distance_(4.0),
+      max_tick_distance_(400),
+      mean_order_lifetime_(2000.0),
+      max_live_orders_(20000),
+      max_order_size_(500),
+      trend_interval_(0),
+      trend_direction_(1),
+      sweep_interval_(0),
+      sweep_levels_(0),
+      random_order_ids_(false)
+{
+}
+
+std::vector<std::string> GetWorkloadPresetNames()
+{
+    std::vector<std::string> names;
+    names.push_back("steady");
+    names.push_back("trend_up");
+    names.push_back("trend_down");
+    names.push_back("sweep");
+    names.push_back("churn");
+    return names;
+}
+
+bool GetWorkloadPreset(const std::string &t_name_, WorkloadConfig &t_config_)
+{
+    WorkloadConfig config;
+    config.name_ = t_name_;
+
+    if (t_name_ == "steady")
+    {
+    }
+    else if (t_name_ == "trend_up" || t_name_ == "trend_down")
+    {
+        // the touch keeps walking away from the centre of the ladder, so the book
+        // has to re-centre (RebuildIndexHighAccess/RebuildIndexLowAccess) over and over
+        config.trend_interval_ = 20;
+        config.trend_direction_ = (t_name_ == "trend_up" ? 1 : -1);
+        config.mean_order_lifetime_ = 500.0;
+    }
+    else if (t_name_ == "sweep")
+    {
+        // wide aggressive orders that take out many levels at once
+        config.mean_tick_distance_ = 10.0;
+        config.sweep_interval_ = 500;
+        config.sweep_levels_ = 40;
+    }
+    else if (t_name_ == "churn")
+    {
+        // very short lived orders with ids scattered over the whole 64 bit space
+        config.add_weight_ = 50;
+        config.cancel_weight_ = 35;
+        config.modify_weight_ = 10;
+        config.replace_weight_ = 5;
+        config.exec_weight_ = 0;
+        config.mean_order_lifetime_ = 8.0;
+        config.random_order_ids_ = true;
+    }
+    else
+    {
+        return false;
+    }
+
+    t_config_ = config;
+    return true;
+}
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadConfig &t_config_)
+    : config_(t_config_),
+      rng_(t_config_.seed_),
+      next_order_id_(1),
+      mid_int_price_(t_config_.start_int_price_),
+      events_(nullptr)
+{
+}
+
+uint64_t WorkloadGenerator::NewOrderId()
+{
+    if (!config_.random_order_ids_)
+    {
+        return next_order_id_++;
+    }
+
+    uint64_t order_id = rng_();
+    while (order_id == 0 || live_orders_.count(order_id) != 0)
+    {
+        order_id = rng_();
+    }
+    return order_id;
+}
+
+int WorkloadGenerator::NewSize()
+{
+    return 1 + (int)(rng_() % config_.max_order_size_);
+}
+
+int WorkloadGenerator::NewPrice(uint8_t t_side_)
+{
+    std::geometric_distribution<int> distance_dist(1.0 / (1.0 + config_.mean_tick_distance_));
+    int distance = std::min(distance_dist(rng_), config_.max_tick_distance_);
+    return (t_side_ == 'B' ? mid_int_price_ - 1 - distance : mid_int_price_ + 1 + distance);
+}
+
+void WorkloadGenerator::Track(uint64_t t_order_id_, uint8_t t_side_, int t_int_price_, int t_size_)
+{
+    LiveOrder order;
+    order.side = t_side_;
+    order.int_price = t_int_price_;
+    order.size = t_size_;
+    live_orders_[t_order_id_] = order;
+
+    live_order_slots_[t_order_id_] = live_order_ids_.size();
+    live_order_ids_.push_back(t_order_id_);
+
+    (t_side_ == 'B' ? bid_levels_ : ask_levels_)[t_int_price_].insert(t_order_id_);
+
+    if (config_.mean_order_lifetime_ > 0.0)
+    {
+        std::exponential_distribution<double> lifetime_dist(1.0 / config_.mean_order_lifetime_);
+        uint64_t expiry = events_->size() + 1 + (uint64_t)lifetime_dist(rng_);
+        expiries_.push(std::make_pair(expiry, t_order_id_));
+    }
+}
+
+void WorkloadGenerator::Untrack(uint64_t t_order_id_)
+{
+    LiveOrder &order = live_orders_[t_order_id_];
+
+    std::map<int, std::set<uint64_t> > &levels = (order.side == 'B' ? bid_levels_ : ask_levels_);
+    std::map<int, std::set<uint64_t> >::iterator level_iter = levels.find(order.int_price);
+    level_iter->second.erase(t_order_id_);
+    if (level_iter->second.empty())
+    {
+        levels.erase(level_iter);
+    }
+
+    size_t slot = live_order_slots_[t_order_id_];
+    live_order_ids_[slot] = live_order_ids_.back();
+    live_order_slots_[live_order_ids_[slot]] = slot;
+    live_order_ids_.pop_back();
+    live_order_slots_.erase(t_order_id_);
+
+    live_orders_.erase(t_order_id_);
+}
+
+uint64_t WorkloadGenerator::RandomLiveOrder()
+{
+    return live_order_ids_[rng_() % live_order_ids_.size()];
+}
+
+void WorkloadGenerator::EmitAdd()
+{
+    uint8_t side = (rng_() & 1) ? 'B' : 'S';
+    uint64_t order_id = NewOrderId();
+    int int_price = NewPrice(side);
+    int size = NewSize();
+
+    OrderEvent event = OrderEvent();
+    event.type = ORDER_EVENT_ADD;
+    event.side = side;
+    event.size = size;
+    event.order_id = order_id;
+    event.price = GetPrice(int_price);
+    events_->push_back(event);
+
+    Track(order_id, side, int_price, size);
+}
+
+void WorkloadGenerator::EmitDelete(uint64_t t_order_id_)
+{
+    OrderEvent event = OrderEvent();
+    event.type = ORDER_EVENT_DELETE;
+    event.side = live_orders_[t_order_id_].side;
+    event.order_id = t_order_id_;
+    events_->push_back(event);
+
+    Untrack(t_order_id_);
+}
+
+void WorkloadGenerator::EmitModify(uint64_t t_order_id_)
+{
+    LiveOrder order = live_orders_[t_order_id_];
+    uint64_t new_order_id = ((rng_() & 1) ? t_order_id_ : NewOrderId());
+    int new_size = NewSize();
+
+    OrderEvent event = OrderEvent();
+    event.type = ORDER_EVENT_MODIFY;
+    event.side = order.side;
+    event.size = new_size;
+    event.order_id = t_order_id_;
+    event.new_order_id = new_order_id;
+    events_->push_back(event);
+
+    Untrack(t_order_id_);
+    Track(new_order_id, order.side, order.int_price, new_size);
+}
+
+void WorkloadGenerator::EmitReplace(uint64_t t_order_id_)
+{
+    LiveOrder order = live_orders_[t_order_id_];
+    uint64_t new_order_id = NewOrderId();
+    int new_int_price = NewPrice(order.side);
+    int new_size = NewSize();
+
+    OrderEvent event = OrderEvent();
+    event.type = ORDER_EVENT_REPLACE;
+    event.side = order.side;
+    event.size = new_size;
+    event.order_id = t_order_id_;
+    event.new_order_id = new_order_id;
+    event.price = GetPrice(new_int_price);
+    events_->push_back(event);
+
+    Untrack(t_order_id_);
+    Track(new_order_id, order.side, new_int_price, new_size);
+}
+
+void WorkloadGenerator::EmitExec(uint64_t t_order_id_, int t_size_exec_)
+{
+    LiveOrder &order = live_orders_[t_order_id_];
+
+    OrderEvent event = OrderEvent();
+    event.type = ORDER_EVENT_EXEC;
+    event.side = order.side;
+    event.size = t_size_exec_;
+    event.order_id = t_order_id_;
+    event.price = GetPrice(order.int_price);
+    events_->push_back(event);
+
+    order.size -= t_size_exec_;
+    if (order.size <= 0)
+    {
+        Untrack(t_order_id_);
+    }
+}
+
+/*
+ * OrderBookManager ignores execs unless both sides of the book have orders, so the
+ * generator never lets an exec take out the last order of a side.
+ */
+void WorkloadGenerator::EmitExecAtTouch()
+{
+    uint8_t side = (rng_() & 1) ? 'B' : 'S';
+    std::map<int, std::set<uint64_t> > &levels = (side == 'B' ? bid_levels_ : ask_levels_);
+    if (bid_levels_.empty() || ask_levels_.empty())
+    {
+        EmitAdd();
+        return;
+    }
+
+    const std::set<uint64_t> &touch = (side == 'B' ? levels.rbegin()->second : levels.begin()->second);
+    uint64_t order_id = *touch.begin();
+    int order_size = live_orders_[order_id].size;
+    int size_exec = 1 + (int)(rng_() % order_size);
+
+    bool is_last_order = (levels.size() == 1 && touch.size() == 1);
+    if (is_last_order && size_exec >= order_size)
+    {
+        if (order_size <= 1)
+        {
+            EmitAdd();
+            return;
+        }
+        size_exec = order_size - 1;
+    }
+    EmitExec(order_id, size_exec);
+}
+
+void WorkloadGenerator::EmitSweep()
+{
+    uint8_t side = (rng_() & 1) ? 'B' : 'S';
+    std::map<int, std::set<uint64_t> > &levels = (side == 'B' ? bid_levels_ : ask_levels_);
+    if (bid_levels_.empty() || ask_levels_.empty())
+    {
+        return;
+    }
+
+    for (unsigned int swept_levels = 0; swept_levels < config_.sweep_levels_ && levels.size() > 1; swept_levels++)
+    {
+        // copy, EmitExec modifies the level while we walk it
+        std::set<uint64_t> touch = (side == 'B' ? levels.rbegin()->second : levels.begin()->second);
+        for (std::set<uint64_t>::iterator iter = touch.begin(); iter != touch.end(); iter++)
+        {
+            EmitExec(*iter, live_orders_[*iter].size);
+        }
+    }
+}
+
+void WorkloadGenerator::MoveMid()
+{
+    mid_int_price_ += config_.trend_direction_;
+
+    // whatever the mid walked over is gone, as if taken out by the trend
+    std::vector<uint64_t> crossed_orders;
+    if (config_.trend_direction_ > 0)
+    {
+        for (std::map<int, std::set<uint64_t> >::iterator iter = ask_levels_.begin();
+             iter != ask_levels_.end() && iter->first <= mid_int_price_; iter++)
+        {
+            crossed_orders.insert(crossed_orders.end(), iter->second.begin(), iter->second.end());
+        }
+    }
+    else
+    {
+        for (std::map<int, std::set<uint64_t> >::reverse_iterator iter = bid_levels_.rbegin();
+             iter != bid_levels_.rend() && iter->first >= mid_int_price_; iter++)
+        {
+            crossed_orders.insert(crossed_orders.end(), iter->second.begin(), iter->second.end());
+        }
+    }
+
+    for (size_t i = 0; i < crossed_orders.size(); i++)
+    {
+        EmitDelete(crossed_orders[i]);
+    }
+}
+
+void WorkloadGenerator::Generate(std::vector<OrderEvent> &t_events_)
+{
+    events_ = &t_events_;
+    t_events_.clear();
+    t_events_.reserve(config_.num_events_);
+
+    const unsigned int total_weight = config_.add_weight_ + config_.cancel_weight_ + config_.modify_weight_ +
+                                      config_.replace_weight_ + config_.exec_weight_;
+
+    uint64_t step = 0;
+    while (t_events_.size() < config_.num_events_)
+    {
+        step++;
+
+        if (config_.trend_interval_ != 0 && step % config_.trend_interval_ == 0)
+        {
+            MoveMid();
+            continue;
+        }
+
+        if (config_.sweep_interval_ != 0 && step % config_.sweep_interval_ == 0)
+        {
+            EmitSweep();
+            continue;
+        }
+
+        // drop expiries of orders which are already gone
+        while (!expiries_.empty() && live_orders_.count(expiries_.top().second) == 0)
+        {
+            expiries_.pop();
+        }
+
+        if (!expiries_.empty() && expiries_.top().first <= t_events_.size())
+        {
+            uint64_t order_id = expiries_.top().second;
+            expiries_.pop();
+            EmitDelete(order_id);
+            continue;
+        }
+
+        if (live_order_ids_.empty() || total_weight == 0)
+        {
+            EmitAdd();
+            continue;
+        }
+
+        if (live_order_ids_.size() >= config_.max_live_orders_)
+        {
+            EmitDelete(RandomLiveOrder());
+            continue;
+        }
+
+        unsigned int draw = (unsigned int)(rng_() % total_weight);
+        if (draw < config_.add_weight_)
+        {
+            EmitAdd();
+        }
+        else if ((draw -= config_.add_weight_) < config_.cancel_weight_)
+        {
+            EmitDelete(RandomLiveOrder());
+        }
+        else if ((draw -= config_.cancel_weight_) < config_.modify_weight_)
+        {
+            EmitModify(RandomLiveOrder());
+        }
+        else if ((draw -= config_.modify_weight_) < config_.replace_weight_)
+        {
+            EmitReplace(RandomLiveOrder());
+        }
+        else
+        {
+            EmitExecAtTouch();
+        }
+    }
+
+    // a sweep or trend step can overshoot
+    t_events_.resize(config_.num_events_);
+    events_ = nullptr;
+}
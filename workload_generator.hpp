@@ -0,0 +1,124 @@
+#ifndef WORKLOAD_GENERATOR_HPP
+#define WORKLOAD_GENERATOR_HPP
+
+#include <cstdint>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "order_event.hpp"
+
+/*
+ * Knobs of the synthetic order flow. The weights are relative, they don't have to
+ * add up to anything. Prices are generated in ticks around a mid price that can
+ * drift, and converted to doubles with min_price_increment_ on the way out.
+ */
+struct WorkloadConfig
+{
+    std::string name_;
+    uint64_t seed_;
+    unsigned int num_events_;
+
+    double min_price_increment_;
+    int start_int_price_;
+
+    // event mix
+    unsigned int add_weight_;
+    unsigned int cancel_weight_;
+    unsigned int modify_weight_;
+    unsigned int replace_weight_;
+    unsigned int exec_weight_;
+
+    // distance (in ticks) of new orders from the touch, geometrically distributed
+    double mean_tick_distance_;
+    int max_tick_distance_;
+
+    // order lifetime (in events), exponentially distributed; 0 disables lifetime based cancels
+    double mean_order_lifetime_;
+    unsigned int max_live_orders_;
+
+    int max_order_size_;
+
+    // mid price moves by one tick every trend_interval_ events in direction trend_direction_
+    unsigned int trend_interval_;
+    int trend_direction_;
+
+    // every sweep_interval_ events, all orders on sweep_levels_ levels of one side are executed
+    unsigned int sweep_interval_;
+    unsigned int sweep_levels_;
+
+    // draw order ids at random from the whole 64 bit space instead of sequentially
+    bool random_order_ids_;
+
+    WorkloadConfig();
+};
+
+// Named presets: "steady", "trend_up", "trend_down", "sweep", "churn"
+bool GetWorkloadPreset(const std::string &t_name_, WorkloadConfig &t_config_);
+std::vector<std::string> GetWorkloadPresetNames();
+
+/*
+ * Seeded generator of OrderEvent streams. It keeps its own model of the live orders
+ * so every delete/modify/replace/exec it emits refers to an order that is live
+ * in the book at that point. The same config always yields the same stream.
+ */
+class WorkloadGenerator
+{
+  private:
+    struct LiveOrder
+    {
+        uint8_t side;
+        int int_price;
+        int size;
+    };
+
+    WorkloadConfig config_;
+    std::mt19937_64 rng_;
+
+    std::unordered_map<uint64_t, LiveOrder> live_orders_;
+    std::vector<uint64_t> live_order_ids_;
+    std::unordered_map<uint64_t, size_t> live_order_slots_;
+
+    // price level -> ids at that level, in arrival order
+    std::map<int, std::set<uint64_t> > bid_levels_;
+    std::map<int, std::set<uint64_t> > ask_levels_;
+
+    // (expiry event number, order id), earliest first
+    std::priority_queue<std::pair<uint64_t, uint64_t>, std::vector<std::pair<uint64_t, uint64_t> >,
+                        std::greater<std::pair<uint64_t, uint64_t> > >
+        expiries_;
+
+    uint64_t next_order_id_;
+    int mid_int_price_;
+    std::vector<OrderEvent> *events_;
+
+    uint64_t NewOrderId();
+    int NewSize();
+    int NewPrice(uint8_t t_side_);
+
+    void Track(uint64_t t_order_id_, uint8_t t_side_, int t_int_price_, int t_size_);
+    void Untrack(uint64_t t_order_id_);
+    uint64_t RandomLiveOrder();
+
+    void EmitAdd();
+    void EmitDelete(uint64_t t_order_id_);
+    void EmitModify(uint64_t t_order_id_);
+    void EmitReplace(uint64_t t_order_id_);
+    void EmitExec(uint64_t t_order_id_, int t_size_exec_);
+    void EmitExecAtTouch();
+    void EmitSweep();
+    void MoveMid();
+
+  public:
+    WorkloadGenerator(const WorkloadConfig &t_config_);
+
+    void Generate(std::vector<OrderEvent> &t_events_);
+
+    double GetPrice(int t_int_price_) const { return t_int_price_ * config_.min_price_increment_; }
+};
+
+#endif